@@ -1,6 +1,7 @@
 #include <kernel/core/catastrophe.h>
 #include <kernel/core/point_array.h>
 #include <kernel/integration/runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -67,6 +68,8 @@ static void catastrophe_Asub1sup4_function(
 		2.0 * PARAM(K_2) * STORAGE_REAL(FSR)));
 }
 
+RUNGE_KUTTA_STEPPER(stepper, catastrophe_Asub1sup4_function, 2)
+
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned  int i, const unsigned int j)
 {
@@ -119,7 +122,7 @@ static void calculate(catastrophe_t *const catastrophe,
 	STORAGE_REAL(FSM) = -0.5 * PARAM(K_2) * (PARAM(LAMBDA_2) *
 			STORAGE_REAL(FL2R));
 
-	runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t catastrophe_Asub1sup4_desc = {
@@ -130,7 +133,9 @@ static catastrophe_desc_t catastrophe_Asub1sup4_desc = {
 	.par_names = par_names,
 	.equation.real = catastrophe_Asub1sup4_function,
 	.num_equations = 2,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int catastrophe_Asub1sup4_init(void) __attribute__ ((constructor));
@@ -1,6 +1,7 @@
 #include <kernel/core/catastrophe.h>
 #include <kernel/core/point_array.h>
 #include <kernel/integration/runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -20,8 +21,8 @@ void catastrophe_Asub3_function(const catastrophe_t *const catastrophe,
 	param1 = catastrophe->parameter[LAMBDA_1].cur_value;
 	param2 = catastrophe->parameter[LAMBDA_2].cur_value;
 
-	l1 = param1 * t;
-	l2 = param2 * t;
+	l1 = PARAM_AT(LAMBDA_1, t);
+	l2 = PARAM_AT(LAMBDA_2, t);
 
 	i21r = 0.25 * (l1 * y[0] + 2.0 * l2 * y[3]);
 	i21m = 0.25 * (l1 * y[1] - 2.0 * l2 * y[2]);
@@ -38,11 +39,43 @@ void catastrophe_Asub3_function(const catastrophe_t *const catastrophe,
 	f[5] = param1 * i21m + param2 * i22m;
 }
 
-static void calculate(catastrophe_t *const catastrophe,
-		const unsigned  int i, const unsigned int j)
+RUNGE_KUTTA_STEPPER(stepper, catastrophe_Asub3_function, 6)
+
+static void catastrophe_Asub3_batch(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double (*y)[CONFIG_BATCH_WIDTH],
+		double (*const f)[CONFIG_BATCH_WIDTH])
+{
+	double l1, l2, i21m, i21r, i22m, i22r;
+	double param1, param2;
+	unsigned int w;
+
+	for (w = 0; w < CONFIG_BATCH_WIDTH; w++) {
+		param1 = p[LAMBDA_1][w];
+		param2 = p[LAMBDA_2][w];
+
+		l1 = param1 * t;
+		l2 = param2 * t;
+
+		i21r = 0.25 * (l1 * y[0][w] + 2.0 * l2 * y[3][w]);
+		i21m = 0.25 * (l1 * y[1][w] - 2.0 * l2 * y[2][w]);
+		i22r = 0.25 * (y[1][w] + l1 * y[3][w] + 2.0 * l2 * y[5][w]);
+		i22m = 0.25 * (-y[0][w] - l1 * y[2][w] - 2.0 * l2 * y[4][w]);
+
+		f[0][w] = param1 * y[2][w] + param2 * y[4][w];
+		f[1][w] = param1 * y[3][w] + param2 * y[5][w];
+
+		f[2][w] = -param1 * y[5][w] + param2 * i21r;
+		f[3][w] = param1 * y[4][w] + param2 * i21m;
+
+		f[4][w] = param1 * i21r + param2 * i22r;
+		f[5][w] = param1 * i21m + param2 * i22m;
+	}
+}
+
+static void initial(catastrophe_t *const catastrophe)
 {
 	equation_t *equation;
-	point_array_t *point_array;
 
 	const double k1 = 1.0, k2 = 1.0;
 
@@ -59,10 +92,8 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(catastrophe);
 
 	equation = catastrophe->equation;
-	point_array = catastrophe->point_array;
 
 	assert(equation);
-	assert(point_array);
 
 	equation->initial_vector[0] = 0.5 * g14 * c8;
 	equation->initial_vector[1] = 0.5 * g14 * s8;
@@ -70,8 +101,18 @@ static void calculate(catastrophe_t *const catastrophe,
 	equation->initial_vector[3] = 0.0;
 	equation->initial_vector[4] = -0.5 * g34 * s38;
 	equation->initial_vector[5] =  0.5 * g34 * c38;
+}
+
+static void calculate(catastrophe_t *const catastrophe,
+		const unsigned  int i, const unsigned int j)
+{
+	assert(catastrophe);
+	assert(catastrophe->equation);
+	assert(catastrophe->point_array);
+
+	initial(catastrophe);
 
-	runge_kutta(0.0, 1.0, 0.001, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.001, catastrophe);
 }
 
 static catastrophe_desc_t catastrophe_Asub3_desc = {
@@ -82,7 +123,13 @@ static catastrophe_desc_t catastrophe_Asub3_desc = {
 	.par_names = par_names,
 	.equation.real = catastrophe_Asub3_function,
 	.num_equations = 6,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1,
+	.initial = initial,
+	.ray_params = PARAM_MASK(LAMBDA_1) | PARAM_MASK(LAMBDA_2),
+	.batch.real = catastrophe_Asub3_batch,
+	.batch_step = 0.001
 };
 
 static int catastrophe_Asub3_init(void) __attribute__ ((constructor));
@@ -1,6 +1,7 @@
 #include <kernel/core/catastrophe.h>
 #include <kernel/core/point_array.h>
 #include <kernel/integration/runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -167,6 +168,8 @@ static void catastrophe_Ksub4_2_function(
 	f[5] = PARAM(LAMBDA_4) * U24m + PARAM(ALPHA) * U2Am;
 }
 
+RUNGE_KUTTA_STEPPER(stepper, catastrophe_Ksub4_2_function, 6)
+
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned  int i, const unsigned int j)
 {
@@ -254,7 +257,7 @@ static void calculate(catastrophe_t *const catastrophe,
 		FL1m * STORAGE_REAL(FP2R);
 	equation_set_function(equation, catastrophe_Ksub4_2_function);
 
-	runge_kutta(0.0, 1.0, 0.001, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.001, catastrophe);
 }
 
 static catastrophe_desc_t catastrophe_Ksub4_2_desc = {
@@ -265,7 +268,9 @@ static catastrophe_desc_t catastrophe_Ksub4_2_desc = {
 	.par_names = par_names,
 	.equation.real = catastrophe_Ksub4_2_function,
 	.num_equations = 6,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int catastrophe_Ksub4_2_init(void) __attribute__ ((constructor));
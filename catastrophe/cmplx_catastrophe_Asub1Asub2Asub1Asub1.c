@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -93,10 +94,13 @@ void cmplx_catastrophe_Asub1Asub2Asub1Asub1_function(
 	f[V1] = V1a*PARAM(ALPHA);
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper,
+		cmplx_catastrophe_Asub1Asub2Asub1Asub1_function, 2)
+
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned int i, const unsigned int j)
 {
-	cmplx_equation_t *equation;
+	cmplx_equation_t *equation, sub[2];
 	point_array_t *point_array;
 
 	const double sqrt_pi = sqrt(M_PI);
@@ -111,32 +115,34 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(equation);
 	assert(point_array);
 
-	/* Precalculate Bsub2(l3) */
-	equation->initial_vector[V] = 0.5 * sqrt_pi *
+	/* Precalculate Bsub2(l3) and Bsub3 */
+	sub[0].num_equations = 1;
+	sub[0].initial_vector[V] = 0.5 * sqrt_pi *
 		cexp(I * PARAM(K_1) * M_PI / 4.0);
-	equation_set_function(equation, Bsub2_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
-	STORAGE_COMPLEX(VB2L3) = equation->resulting_vector[V];
+	equation_set_function(&sub[0], Bsub2_function);
 
-	/* Precalculate Bsub3 */
-	equation->initial_vector[V] = (1.0 / 3.0) * g13 *
+	sub[1].num_equations = 2;
+	sub[1].initial_vector[V] = (1.0 / 3.0) * g13 *
 		cexp(I * PARAM(K_2) * M_PI / 6.0);
-	equation->initial_vector[V1] = (I / 3.0) * g23 *
+	sub[1].initial_vector[V1] = (I / 3.0) * g23 *
 		cexp(I * PARAM(K_2) * M_PI / 3.0);
-	equation_set_function(equation, Bsub3_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	equation_set_function(&sub[1], Bsub3_function);
+
+	cmplx_catastrophe_integrate_subs(catastrophe, sub, 2, 0.01);
+
+	STORAGE_COMPLEX(VB2L3) = sub[0].resulting_vector[V];
 
-	STORAGE_COMPLEX(VB3L1L2) = equation->resulting_vector[V];
-	STORAGE_COMPLEX(DVB3L1L2) = equation->resulting_vector[V1];
+	STORAGE_COMPLEX(VB3L1L2) = sub[1].resulting_vector[V];
+	STORAGE_COMPLEX(DVB3L1L2) = sub[1].resulting_vector[V1];
 	STORAGE_COMPLEX(DDVB3L1L2) = (PARAM(K_2) / 3.) *
-		(PARAM(LAMBDA_1) * equation->resulting_vector[V] - 2 * I *
-		PARAM(LAMBDA_2) * equation->resulting_vector[V1] - I);
+		(PARAM(LAMBDA_1) * sub[1].resulting_vector[V] - 2 * I *
+		PARAM(LAMBDA_2) * sub[1].resulting_vector[V1] - I);
 
 	equation->initial_vector[V] = STORAGE_COMPLEX(VB2L3) * STORAGE_COMPLEX(VB3L1L2);
 	equation->initial_vector[V1] = STORAGE_COMPLEX(VB2L3) * STORAGE_COMPLEX(DVB3L1L2);
 	equation_set_function(equation,
 			cmplx_catastrophe_Asub1Asub2Asub1Asub1_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t
@@ -148,7 +154,10 @@ static catastrophe_desc_t
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Asub1Asub2Asub1Asub1_function,
 	.num_equations = 2,
-	.calculate = calculate
+	.calculate = calculate,
+	.num_subs = 2,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int Asub1Asub2Asub1Asub1_init(void) __attribute__ ((constructor));
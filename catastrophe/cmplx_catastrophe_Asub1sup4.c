@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -50,6 +51,8 @@ void cmplx_catastrophe_Asub1sup4_function(
 	f[V] = PARAM(ALPHA) * U0a;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Asub1sup4_function, 1)
+
 void cmplx_catastrophe_Bsub2l1_function(
 		const catastrophe_t *const catastrophe,
 		const double t, const double complex *y,
@@ -105,7 +108,7 @@ static void calculate(catastrophe_t *const catastrophe,
 
 	equation->initial_vector[V] = STORAGE_COMPLEX(F2l1) * STORAGE_COMPLEX(F2l2);
 	equation_set_function(equation, cmplx_catastrophe_Asub1sup4_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.008, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.008, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Asub1sup4_desc = {
@@ -116,7 +119,9 @@ static catastrophe_desc_t cmplx_catastrophe_Asub1sup4_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Asub1sup4_function,
 	.num_equations = 1,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Asub1sup4_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -28,8 +29,8 @@ void cmplx_catastrophe_Asub3_function(
 	param1 = catastrophe->parameter[LAMBDA_1].cur_value;
 	param2 = catastrophe->parameter[LAMBDA_2].cur_value;
 
-	l1 = param1 * t;
-	l2 = param2 * t;
+	l1 = PARAM_AT(LAMBDA_1, t);
+	l2 = PARAM_AT(LAMBDA_2, t);
 
 	i21 = 0.25 * (l1 * y[V] - 2.0 * I * l2 * y[V1]);
 	i22 = -0.25 * I * (y[V] + l1 * y[V1] + 2.0 * l2 * y[V2]);
@@ -39,11 +40,38 @@ void cmplx_catastrophe_Asub3_function(
 	f[V2] = param1 * i21 + param2 * i22;
 }
 
-static void calculate(catastrophe_t *const catastrophe,
-		const unsigned  int i, const unsigned int j)
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Asub3_function, 3)
+
+static void cmplx_catastrophe_Asub3_batch(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double complex (*y)[CONFIG_BATCH_WIDTH],
+		double complex (*const f)[CONFIG_BATCH_WIDTH])
+{
+	double l1, l2;
+	double param1, param2;
+	double complex i21, i22;
+	unsigned int w;
+
+	for (w = 0; w < CONFIG_BATCH_WIDTH; w++) {
+		param1 = p[LAMBDA_1][w];
+		param2 = p[LAMBDA_2][w];
+
+		l1 = param1 * t;
+		l2 = param2 * t;
+
+		i21 = 0.25 * (l1 * y[V][w] - 2.0 * I * l2 * y[V1][w]);
+		i22 = -0.25 * I *
+			(y[V][w] + l1 * y[V1][w] + 2.0 * l2 * y[V2][w]);
+
+		f[V][w]  = param1 * y[V1][w] + param2 * y[V2][w];
+		f[V1][w] = I * y[V2][w] * param1 + i21 * param2;
+		f[V2][w] = param1 * i21 + param2 * i22;
+	}
+}
+
+static void initial(catastrophe_t *const catastrophe)
 {
 	cmplx_equation_t *equation;
-	point_array_t *point_array;
 
 	/* Gamma function's precalculated values */
 	const double g14 = 3.625609908;
@@ -52,17 +80,25 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(catastrophe);
 
 	equation = catastrophe->equation;
-	point_array = catastrophe->point_array;
 
 	assert(equation);
-	assert(point_array);
 
 	equation->initial_vector[V] = 0.5 * g14 * cexp(I * M_PI / 8.0);
 	equation->initial_vector[V1] = 0;
 	equation->initial_vector[V2] = 0.5 * I * g34 *
 		cexp(I * 3.0 * M_PI / 8.0);
+}
+
+static void calculate(catastrophe_t *const catastrophe,
+		const unsigned  int i, const unsigned int j)
+{
+	assert(catastrophe);
+	assert(catastrophe->equation);
+	assert(catastrophe->point_array);
+
+	initial(catastrophe);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Asub3_desc = {
@@ -73,7 +109,13 @@ static catastrophe_desc_t cmplx_catastrophe_Asub3_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Asub3_function,
 	.num_equations = 3,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1,
+	.initial = initial,
+	.ray_params = PARAM_MASK(LAMBDA_1) | PARAM_MASK(LAMBDA_2),
+	.batch.cmplx = cmplx_catastrophe_Asub3_batch,
+	.batch_step = 0.01
 };
 
 static int cmplx_catastrophe_Asub3_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -24,8 +25,8 @@ void cmplx_catastrophe_Bsub3_function(
 	double l1, l2;
 	complex double U11, U12;
 
-	l1 = PARAM(LAMBDA_1) * t;
-	l2 = PARAM(LAMBDA_2) * t;
+	l1 = PARAM_AT(LAMBDA_1, t);
+	l2 = PARAM_AT(LAMBDA_2, t);
 
 	U11 = (PARAM(K) / 3.0) * (l1 * y[V] - 2.0 * I * l2 * y[V1] - I);
 	U12 = -(PARAM(K) * I / 3.0) *
@@ -35,11 +36,35 @@ void cmplx_catastrophe_Bsub3_function(
 	f[V1] = PARAM(LAMBDA_1) * U11 + PARAM(LAMBDA_2) * U12;
 }
 
-static void calculate(catastrophe_t *const catastrophe,
-		const unsigned int i, const unsigned int j)
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Bsub3_function, 2)
+
+static void cmplx_catastrophe_Bsub3_batch(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double complex (*y)[CONFIG_BATCH_WIDTH],
+		double complex (*const f)[CONFIG_BATCH_WIDTH])
+{
+	double l1, l2;
+	complex double U11, U12;
+	unsigned int w;
+
+	for (w = 0; w < CONFIG_BATCH_WIDTH; w++) {
+		l1 = p[LAMBDA_1][w] * t;
+		l2 = p[LAMBDA_2][w] * t;
+
+		U11 = (p[K][w] / 3.0) *
+			(l1 * y[V][w] - 2.0 * I * l2 * y[V1][w] - I);
+		U12 = -(p[K][w] * I / 3.0) *
+			(y[V][w] + l1 * y[V1][w] - 2.0 * I * l2 * U11);
+
+		f[V][w] = p[LAMBDA_1][w] * y[V1][w] +
+			p[LAMBDA_2][w] * (-I * U11);
+		f[V1][w] = p[LAMBDA_1][w] * U11 + p[LAMBDA_2][w] * U12;
+	}
+}
+
+static void initial(catastrophe_t *const catastrophe)
 {
 	cmplx_equation_t *equation;
-	point_array_t *point_array;
 
 	/* Gamma function's precalculated values */
 	const double g13 = 2.678938534;
@@ -48,18 +73,26 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(catastrophe);
 
 	equation = catastrophe->equation;
-	point_array = catastrophe->point_array;
 
 	assert(equation);
-	assert(point_array);
 
 	/* Calculate Bsub3 */
 	equation->initial_vector[V] = (1.0 / 3.0) * g13 *
 		cexp(I * PARAM(K) * M_PI / 6.0);
 	equation->initial_vector[V1] = (I / 3.0) * g23 *
 		cexp(I * PARAM(K) * M_PI / 3.0);
+}
+
+static void calculate(catastrophe_t *const catastrophe,
+		const unsigned int i, const unsigned int j)
+{
+	assert(catastrophe);
+	assert(catastrophe->equation);
+	assert(catastrophe->point_array);
+
+	initial(catastrophe);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Bsub3_desc = {
@@ -70,7 +103,13 @@ static catastrophe_desc_t cmplx_catastrophe_Bsub3_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Bsub3_function,
 	.num_equations = 2,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1,
+	.initial = initial,
+	.ray_params = PARAM_MASK(LAMBDA_1) | PARAM_MASK(LAMBDA_2),
+	.batch.cmplx = cmplx_catastrophe_Bsub3_batch,
+	.batch_step = 0.01
 };
 
 static int cmplx_catastrophe_Bsub3_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -38,6 +39,8 @@ void cmplx_catastrophe_Csub3_function(
 	f[V] = PARAM(LAMBDA_1) * U01 + PARAM(LAMBDA_2) * U02;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Csub3_function, 1)
+
 static void cmplx_catastrophe_Airy_function(
 		const catastrophe_t *const catastrophe,
 		const double t, const double complex *y,
@@ -85,7 +88,7 @@ static void calculate(catastrophe_t *const catastrophe,
 	/* A simple hack to reduce calculation time. */
 	equation->num_equations = 1;
 	equation_set_function(equation, cmplx_catastrophe_Csub3_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Csub3_desc = {
@@ -96,7 +99,9 @@ static catastrophe_desc_t cmplx_catastrophe_Csub3_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Csub3_function,
 	.num_equations = 2,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Csub3_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -55,6 +56,8 @@ void cmplx_catastrophe_Csub4_function(
 		PARAM(LAMBDA_3) * U03;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Csub4_function, 1)
+
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned int i, const unsigned int j)
 {
@@ -87,7 +90,7 @@ static void calculate(catastrophe_t *const catastrophe,
 	/* Calculate Csub4 */
 	equation->initial_vector[V] = M_PI;
 	equation_set_function(equation, cmplx_catastrophe_Csub4_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Csub4_desc = {
@@ -98,7 +101,9 @@ static catastrophe_desc_t cmplx_catastrophe_Csub4_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Csub4_function,
 	.num_equations = 3,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Csub4_init(void) __attribute__ ((constructor));
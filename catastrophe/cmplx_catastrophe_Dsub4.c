@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -30,9 +31,9 @@ void cmplx_catastrophe_Dsub4_function(
 		       U31, U32, U33,
 	               U41, U42, U43;
 
-	l1 = PARAM(LAMBDA_1) * t;
-	l2 = PARAM(LAMBDA_2) * t;
-	l3 = PARAM(LAMBDA_3) * t;
+	l1 = PARAM_AT(LAMBDA_1, t);
+	l2 = PARAM_AT(LAMBDA_2, t);
+	l3 = PARAM_AT(LAMBDA_3, t);
 
 	U11 = y[V1]; U12 = y[V2]; U13 = y[V3];
 
@@ -57,11 +58,53 @@ void cmplx_catastrophe_Dsub4_function(
 		PARAM(LAMBDA_3);
 }
 
-static void calculate(catastrophe_t *const catastrophe,
-		const unsigned  int i, const unsigned int j)
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Dsub4_function, 4)
+
+static void cmplx_catastrophe_Dsub4_batch(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double complex (*y)[CONFIG_BATCH_WIDTH],
+		double complex (*const f)[CONFIG_BATCH_WIDTH])
+{
+	double l1, l2, l3;
+	double complex U11, U12, U13,
+	               U21, U22, U23,
+		       U31, U32, U33,
+	               U41, U42, U43;
+	unsigned int w;
+
+	for (w = 0; w < CONFIG_BATCH_WIDTH; w++) {
+		l1 = p[LAMBDA_1][w] * t;
+		l2 = p[LAMBDA_2][w] * t;
+		l3 = p[LAMBDA_3][w] * t;
+
+		U11 = y[V1][w]; U12 = y[V2][w]; U13 = y[V3][w];
+
+		U21 = p[B][w] * (l2 * y[V][w] - 3.0 * I * y[V3][w] -
+			2.0 * I * l3 * y[V2][w]);
+		U22 = U31 = 0.5 * l1 * y[V][w] * p[B][w];
+		U23 = U41 = 0.5 * (-I) * l1 * y[V2][w]  * p[B][w];
+
+		U32 = I * y[V3][w];
+		U33 = U42 = -I/3.0 * (0.5 * y[V][w] + l2 * y[V2][w] +
+			2.0 * l3 * y[V3][w] - 0.5 * l1 * y[V1][w]);
+
+		U43 = -1.0/3.0 * (3.0/2.0 * y[V2][w] + l2 * I * y[V3][w] +
+			2.0 * l3 * U42 - 0.5 * l1 * U22);
+
+		f[V][w] = U11 * p[LAMBDA_1][w] + U12 * p[LAMBDA_2][w] + U13 *
+			p[LAMBDA_3][w];
+		f[V1][w] = U21 * p[LAMBDA_1][w] + U22 * p[LAMBDA_2][w] + U23 *
+			p[LAMBDA_3][w];
+		f[V2][w] = U31 * p[LAMBDA_1][w] + U32 * p[LAMBDA_2][w] + U33 *
+			p[LAMBDA_3][w];
+		f[V3][w] = U41 * p[LAMBDA_1][w] + U42 * p[LAMBDA_2][w] + U43 *
+			p[LAMBDA_3][w];
+	}
+}
+
+static void initial(catastrophe_t *const catastrophe)
 {
 	cmplx_equation_t *equation;
-	point_array_t *point_array;
 
 	/* Gamma function's precalculated values */
 	const double g16 = 5.566316001;
@@ -77,10 +120,8 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(catastrophe);
 
 	equation = catastrophe->equation;
-	point_array = catastrophe->point_array;
 
 	assert(equation);
-	assert(point_array);
 
 	equation->initial_vector[V] = sqrt2p / 3.0 * g16 *
 		(cp12 - PARAM(B) * cp12);
@@ -88,8 +129,18 @@ static void calculate(catastrophe_t *const catastrophe,
 	equation->initial_vector[V2] = -M_PI / 3.0 * (1.0 + PARAM(B));
 	equation->initial_vector[V3] = I * sqrt2p / 3.0 * g56 *
 		(c5p12 - PARAM(B) * c5p12);
+}
+
+static void calculate(catastrophe_t *const catastrophe,
+		const unsigned  int i, const unsigned int j)
+{
+	assert(catastrophe);
+	assert(catastrophe->equation);
+	assert(catastrophe->point_array);
+
+	initial(catastrophe);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Dsub4_desc = {
@@ -100,7 +151,14 @@ static catastrophe_desc_t cmplx_catastrophe_Dsub4_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Dsub4_function,
 	.num_equations = 4,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1,
+	.initial = initial,
+	.ray_params = PARAM_MASK(LAMBDA_1) | PARAM_MASK(LAMBDA_2) |
+		PARAM_MASK(LAMBDA_3),
+	.batch.cmplx = cmplx_catastrophe_Dsub4_batch,
+	.batch_step = 0.01
 };
 
 static int cmplx_catastrophe_Dsub4_init(void) __attribute__ ((constructor));
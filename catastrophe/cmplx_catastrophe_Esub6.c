@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -41,11 +42,11 @@ void cmplx_catastrophe_Esub6_function(
 		U52, U54, U222, U422,
 		U53, U55, U333, U331;
 
-	l1 = PARAM(LAMBDA_1) * t;
-	l2 = PARAM(LAMBDA_2) * t;
-	l3 = PARAM(LAMBDA_3) * t;
-	l4 = PARAM(LAMBDA_4) * t;
-	l5 = PARAM(LAMBDA_5) * t;
+	l1 = PARAM_AT(LAMBDA_1, t);
+	l2 = PARAM_AT(LAMBDA_2, t);
+	l3 = PARAM_AT(LAMBDA_3, t);
+	l4 = PARAM_AT(LAMBDA_4, t);
+	l5 = PARAM_AT(LAMBDA_5, t);
 
 	/* Depends on nothing */
 	U31 = PARAM(K_1) / 4.0 *
@@ -148,11 +149,11 @@ void cmplx_catastrophe_Esub6_function(
 		U55 * PARAM(LAMBDA_5);
 }
 
-static void calculate(catastrophe_t *const catastrophe,
-		const unsigned int i, const unsigned int j)
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Esub6_function, 6)
+
+static void initial(catastrophe_t *const catastrophe)
 {
 	cmplx_equation_t *equation;
-	point_array_t *point_array;
 
 	/* Gamma function's precalculated values */
 	static const double g14 = 3.625609908;
@@ -163,10 +164,8 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(catastrophe);
 
 	equation = catastrophe->equation;
-	point_array = catastrophe->point_array;
 
 	assert(equation);
-	assert(point_array);
 
 	equation->initial_vector[V] = 0.5 / sqrt(3.0) * g13 * g14 *
 		cexp(I * PARAM(K_1) * M_PI / 8.0);
@@ -184,8 +183,18 @@ static void calculate(catastrophe_t *const catastrophe,
 
 	equation->initial_vector[V5] = -PARAM(K_2) / (2.0 * sqrt(3.0)) *
 		g23 * g34 * cexp(I * PARAM(K_1) * 3.0 * M_PI / 8.0);
+}
+
+static void calculate(catastrophe_t *const catastrophe,
+		const unsigned int i, const unsigned int j)
+{
+	assert(catastrophe);
+	assert(catastrophe->equation);
+	assert(catastrophe->point_array);
+
+	initial(catastrophe);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Esub6_desc = {
@@ -196,7 +205,13 @@ static catastrophe_desc_t cmplx_catastrophe_Esub6_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Esub6_function,
 	.num_equations = 6,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1,
+	.initial = initial,
+	.ray_params = PARAM_MASK(LAMBDA_1) | PARAM_MASK(LAMBDA_2) |
+		PARAM_MASK(LAMBDA_3) | PARAM_MASK(LAMBDA_4) |
+		PARAM_MASK(LAMBDA_5)
 };
 
 static int cmplx_catastrophe_Esub6_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -118,6 +119,8 @@ void cmplx_catastrophe_Fsub1_0_function(
 		PARAM(ALPHA) * U35;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Fsub1_0_function, 4)
+
 static void cmplx_catastrophe_Airy_function(
 		const catastrophe_t *const catastrophe,
 		const double t, const double complex *y,
@@ -180,7 +183,7 @@ static void calculate(catastrophe_t *const catastrophe,
 
 	equation_set_function(equation, cmplx_catastrophe_Fsub1_0_function);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.001, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.001, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Fsub1_0_desc = {
@@ -191,7 +194,9 @@ static catastrophe_desc_t cmplx_catastrophe_Fsub1_0_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Fsub1_0_function,
 	.num_equations = 4,
-	.calculate = calculate
+	.calculate = calculate,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Fsub_1_0_init(void) __attribute__ ((constructor));
@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -51,6 +52,8 @@ void cmplx_catastrophe_Fsub4_function(
 	f[V1] = PARAM(LAMBDA_3) * U13;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Fsub4_function, 2)
+
 static void cmplx_catastrophe_Frenaile_function(
 		const catastrophe_t *const catastrophe,
 		const double t, const double complex *y,
@@ -79,7 +82,7 @@ static void cmplx_catastrophe_Airy_function(
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned int i, const unsigned int j)
 {
-	cmplx_equation_t *equation;
+	cmplx_equation_t *equation, sub[2];
 	point_array_t *point_array;
 
 	double complex F2;
@@ -97,24 +100,27 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(equation);
 	assert(point_array);
 
-	equation->initial_vector[V] = 0.5 * sqrt(M_PI) *
+	/* The Fresnel integral of l2 and the Airy function of l1 */
+	sub[0].num_equations = 1;
+	sub[0].initial_vector[V] = 0.5 * sqrt(M_PI) *
 		cexp(I * PARAM(K) * M_PI / 4.0);
-	equation_set_function(equation, cmplx_catastrophe_Frenaile_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
-	F2 = equation->resulting_vector[V];
+	equation_set_function(&sub[0], cmplx_catastrophe_Frenaile_function);
+
+	sub[1].num_equations = 2;
+	sub[1].initial_vector[V] = divsqrt3 * g13;
+	sub[1].initial_vector[V1] = -divsqrt3 * g23;
+	equation_set_function(&sub[1], cmplx_catastrophe_Airy_function);
 
-	equation->initial_vector[V] = divsqrt3 * g13;
-	equation->initial_vector[V1] = -divsqrt3 * g23;
-	equation_set_function(equation, cmplx_catastrophe_Airy_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	cmplx_catastrophe_integrate_subs(catastrophe, sub, 2, 0.01);
 
-	STORAGE_COMPLEX(Ai) = equation->resulting_vector[V];
-	STORAGE_COMPLEX(Aid) = equation->resulting_vector[V1];
+	F2 = sub[0].resulting_vector[V];
+	STORAGE_COMPLEX(Ai) = sub[1].resulting_vector[V];
+	STORAGE_COMPLEX(Aid) = sub[1].resulting_vector[V1];
 
 	equation->initial_vector[V] = STORAGE_COMPLEX(Ai) * F2;
 	equation->initial_vector[V1] = STORAGE_COMPLEX(Aid) * F2;
 	equation_set_function(equation, cmplx_catastrophe_Fsub4_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.008, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.008, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Fsub4_desc = {
@@ -125,7 +131,10 @@ static catastrophe_desc_t cmplx_catastrophe_Fsub4_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Fsub4_function,
 	.num_equations = 2,
-	.calculate = calculate
+	.calculate = calculate,
+	.num_subs = 2,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Fsub4_init(void) __attribute__ ((constructor));
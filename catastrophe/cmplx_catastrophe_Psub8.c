@@ -1,5 +1,6 @@
 #include <kernel/core/point_array.h>
 #include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
 
 #include <math.h>
 
@@ -234,6 +235,8 @@ void cmplx_catastrophe_Psub8_function(
 	f[Va] = PARAM(ALPHA) * Uaa;
 }
 
+CMPLX_RUNGE_KUTTA_STEPPER(stepper, cmplx_catastrophe_Psub8_function, 8)
+
 static void cmplx_catastrophe_Airyl1_function(
 		const catastrophe_t *const catastrophe,
 		const double t, const double complex *y,
@@ -285,8 +288,9 @@ static void cmplx_catastrophe_Airyl3_function(
 static void calculate(catastrophe_t *const catastrophe,
 		const unsigned int i, const unsigned int j)
 {
-	cmplx_equation_t *equation;
+	cmplx_equation_t *equation, airy[3];
 	point_array_t *point_array;
+	unsigned int k;
 
 	double ail1, ail2, ail3,
 	       aidl1, aidl2, aidl3;
@@ -304,26 +308,23 @@ static void calculate(catastrophe_t *const catastrophe,
 	assert(equation);
 	assert(point_array);
 
-	equation->initial_vector[V] = divsqrt3 * g13;
-	equation->initial_vector[V1] = -divsqrt3 * g23;
-	equation_set_function(equation, cmplx_catastrophe_Airyl1_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
-	ail1 = equation->resulting_vector[V];
-	aidl1 = equation->resulting_vector[V1];
-
-	equation->initial_vector[V] = divsqrt3 * g13;
-	equation->initial_vector[V1] = -divsqrt3 * g23;
-	equation_set_function(equation, cmplx_catastrophe_Airyl2_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
-	ail2 = equation->resulting_vector[V];
-	aidl2 = equation->resulting_vector[V1];
-
-	equation->initial_vector[V] = divsqrt3 * g13;
-	equation->initial_vector[V1] = -divsqrt3 * g23;
-	equation_set_function(equation, cmplx_catastrophe_Airyl3_function);
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
-	ail3 = equation->resulting_vector[V];
-	aidl3 = equation->resulting_vector[V1];
+	/* The Airy functions of l1, l2 and l3 are independent */
+	for (k = 0; k < 3; k++) {
+		airy[k].num_equations = 2;
+		airy[k].initial_vector[V] = divsqrt3 * g13;
+		airy[k].initial_vector[V1] = -divsqrt3 * g23;
+	}
+	equation_set_function(&airy[0], cmplx_catastrophe_Airyl1_function);
+	equation_set_function(&airy[1], cmplx_catastrophe_Airyl2_function);
+	equation_set_function(&airy[2], cmplx_catastrophe_Airyl3_function);
+	cmplx_catastrophe_integrate_subs(catastrophe, airy, 3, 0.01);
+
+	ail1 = airy[0].resulting_vector[V];
+	aidl1 = airy[0].resulting_vector[V1];
+	ail2 = airy[1].resulting_vector[V];
+	aidl2 = airy[1].resulting_vector[V1];
+	ail3 = airy[2].resulting_vector[V];
+	aidl3 = airy[2].resulting_vector[V1];
 
 	equation->initial_vector[V] = ail1 * ail2 * ail3;
 	equation->initial_vector[V1] = aidl1 * ail2 * ail3;
@@ -336,7 +337,7 @@ static void calculate(catastrophe_t *const catastrophe,
 
 	equation_set_function(equation, cmplx_catastrophe_Psub8_function);
 
-	cmplx_runge_kutta(0.0, 1.0, 0.01, catastrophe);
+	catastrophe->integrate(0.0, 1.0, 0.01, catastrophe);
 }
 
 static catastrophe_desc_t cmplx_catastrophe_Psub8_desc = {
@@ -347,7 +348,10 @@ static catastrophe_desc_t cmplx_catastrophe_Psub8_desc = {
 	.par_names = par_names,
 	.equation.cmplx = cmplx_catastrophe_Psub8_function,
 	.num_equations = 8,
-	.calculate = calculate
+	.calculate = calculate,
+	.num_subs = 3,
+	.stepper = stepper,
+	.linear = 1
 };
 
 static int cmplx_catastrophe_Psub8_init(void) __attribute__ ((constructor));
@@ -0,0 +1,27 @@
+#ifndef __CACHE_FILE_H__
+#define __CACHE_FILE_H__
+
+#include <kernel/cache/simple.h>
+
+/*
+ * The results kept in a file shared by the processes, a section per
+ * derivative of a descriptor and the way its results are computed. The
+ * readers take no lock, the writers call cache_file_save() between
+ * cache_file_lock() and cache_file_unlock().
+ */
+struct cache_file_section;
+
+int cache_file_open(const char *path);
+struct cache_file_section *cache_file_section(const char *name,
+		unsigned int type, unsigned int deriv,
+		unsigned int num_parameters, char **par_names,
+		unsigned int sweep, unsigned int method, double tol,
+		int create);
+int cache_file_search(struct cache_file_section *section,
+		struct cached_result *key);
+void cache_file_lock(void);
+void cache_file_unlock(void);
+int cache_file_save(struct cache_file_section *section,
+		struct cached_result *result);
+
+#endif
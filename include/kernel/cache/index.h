@@ -0,0 +1,19 @@
+#ifndef __CACHE_INDEX_H__
+#define __CACHE_INDEX_H__
+
+#include <kernel/cache/simple.h>
+
+/*
+ * A hash table of the results of a cache read without any lock. The writer
+ * holds the lock of the cache, see cache_index_insert().
+ */
+struct cache_index;
+
+struct cached_result *cache_index_search(struct cache_index **index,
+		struct cached_result *key);
+int cache_index_insert(struct cache_index **index,
+		struct cached_result *result);
+void cache_index_reclaim(void);
+void cache_index_destroy(struct cache_index **index);
+
+#endif
@@ -4,16 +4,49 @@
 #include <kernel/core/point_array.h>
 #include <kernel/core/config.h>
 #include <complex.h>
+#include <stdint.h>
 
+/*
+ * A result is followed by the values of its num_parameters parameters, the
+ * caches keep it in cached_result_size() bytes.
+ */
 struct cached_result {
-	double         parameter[CONFIG_CAT_MAX_PARAMETERS];
-	unsigned int   num_parameters;
+	/* Root the result is saved to, a part of the key of the hash cache */
+	void         **root;
 	point_t        point;
+	unsigned int   num_parameters;
+	/* Sweeps of the eviction the result survives, raised by the hits */
+	unsigned int   clock;
+	double         parameter[];
+};
+
+#define CACHED_RESULT_CLOCK_MAX 3
+
+#define cached_result_size(num) \
+	(sizeof(struct cached_result) + (num) * sizeof(double))
+
+/* A result with the room for the parameters of any catastrophe */
+union cached_key {
+	struct cached_result result;
+	char                 bytes[cached_result_size(CONFIG_CAT_MAX_PARAMETERS)];
 };
 
-int simple_cache_save_result(void **root, struct cached_result *result);
+/*
+ * cached_result_touch() - note the hit of the result, it is written only
+ * while the clock is not at its maximum.
+ */
+static inline void cached_result_touch(struct cached_result *result)
+{
+	unsigned int clock = __atomic_load_n(&result->clock, __ATOMIC_RELAXED);
+
+	if (clock < CACHED_RESULT_CLOCK_MAX)
+		__atomic_store_n(&result->clock, clock + 1, __ATOMIC_RELAXED);
+}
+
+int simple_cache_save_result(void **root, struct cached_result *key);
 struct cached_result *simple_cache_search_result(void **root,
 		struct cached_result *result);
-struct cached_result *simple_cache_cached_result_alloc(void);
+void simple_cache_reclaim(void);
+void simple_cache_set_budget(uint64_t bytes);
 
 #endif
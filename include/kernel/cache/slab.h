@@ -0,0 +1,43 @@
+#ifndef __CACHE_SLAB_H__
+#define __CACHE_SLAB_H__
+
+#include <kernel/cache/simple.h>
+#include <stddef.h>
+#include <stdint.h>
+
+struct cache_chunk;
+
+/*
+ * The entries of a cache carved one after another from large chunks, all of
+ * the same size. The owner of the slab serializes the allocations, the
+ * entries are evicted and moved by cache_slab_evict() and
+ * cache_slab_compact() only when no job is running.
+ */
+struct cache_slab {
+	/* Next of all the slabs of the process */
+	struct cache_slab  *next;
+	/* Cache the slab belongs to */
+	void               *owner;
+	/* Chunks from the oldest to the one being filled */
+	struct cache_chunk *first;
+	struct cache_chunk *last;
+	uint64_t            num_chunks;
+	uint64_t            num_entries;
+	size_t              entry_size;
+	/* Hand of the CLOCK: the chunk and the offset of the next entry */
+	struct cache_chunk *hand;
+	size_t              hand_pos;
+	/* An entry was refused for the quota, or some entries were evicted */
+	int                 refused;
+	int                 evicted;
+};
+
+void cache_slab_init(struct cache_slab *slab, void *owner);
+void *cache_slab_alloc(struct cache_slab *slab, size_t size);
+struct cache_slab *cache_slab_next(struct cache_slab *slab);
+int cache_slab_evict(void);
+void cache_slab_compact(struct cache_slab *slab,
+		void (*add)(struct cache_slab *slab,
+			struct cached_result *entry));
+
+#endif
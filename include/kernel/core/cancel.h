@@ -0,0 +1,42 @@
+#ifndef _WAVECAT_CANCEL_H_
+#define _WAVECAT_CANCEL_H_
+
+#include <time.h>
+
+/* Why a job is cancelled */
+enum cancel_reason_e {
+	CANCEL_NONE = 0,
+	/* A point has diverged or a thread has failed */
+	CANCEL_FAILED,
+	CANCEL_DEADLINE,
+	/* The SCGI client has closed the connection */
+	CANCEL_DISCONNECT,
+};
+
+typedef enum cancel_reason_e cancel_reason_t;
+
+/*
+ * The token is shared by all the threads computing a job, they check it
+ * between the rows of the grid and stop as soon as it is tripped.
+ */
+struct cancel_token {
+	/* Written by the threads with atomic builtins only */
+	int             reason;
+	/* Monotonic time the job must end by, zero if there is no limit */
+	struct timespec deadline;
+	/* Socket of the client polled for the disconnect, or -1 */
+	int             client_fd;
+};
+
+typedef struct cancel_token cancel_token_t;
+
+void cancel_token_init(cancel_token_t *token, int client_fd, double timeout);
+void cancel_token_trip(cancel_token_t *token, cancel_reason_t reason);
+cancel_reason_t cancel_token_check(cancel_token_t *token);
+
+static inline cancel_reason_t cancel_token_reason(cancel_token_t *token)
+{
+	return __atomic_load_n(&token->reason, __ATOMIC_RELAXED);
+}
+
+#endif /* _WAVECAT_CANCEL_H_ */
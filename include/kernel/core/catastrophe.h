@@ -6,13 +6,19 @@
 #include <kernel/core/equation.h>
 #include <kernel/core/cmplx_equation.h>
 #include <kernel/core/point_array.h>
+#include <kernel/core/cancel.h>
 #include <kernel/adt/list.h>
+#include <kernel/integration/stats.h>
 
 #include <pthread.h>
 
 #define MAX_NAME_LEN 80
 
 #define PARAM(num)    (catastrophe->parameter[(num)].cur_value)
+#define PARAM_MASK(num) (1UL << (num))
+/* Value of the parameter on the integration path at t */
+#define PARAM_AT(num, t) \
+	(PARAM(num) * (t) + catastrophe->origin[(num)])
 #define STORAGE_REAL(num)     (((equation_t *)(catastrophe->equation))->storage[(num)])
 #define STORAGE_COMPLEX(num)  (((cmplx_equation_t *)(catastrophe->equation))->storage[(num)])
 
@@ -30,13 +36,62 @@ enum catastrophe_type_e {
 	CT_COMPLEX,
 };
 
-typedef struct parameter_s         parameter_t;
-typedef enum   catastrophe_type_e  catastrophe_type_t;
+/*
+ * The order the points of the grid are computed in. SWEEP_RAY integrates
+ * once per ray from the origin and fills the nearer points of the ray from
+ * the dense output. SWEEP_CONTINUATION integrates between the neighbouring
+ * points of a serpentine path.
+ */
+enum catastrophe_sweep_e {
+	SWEEP_POINT = 0,
+	SWEEP_RAY,
+	SWEEP_CONTINUATION,
+};
+
+/*
+ * The method integrating the system of the descriptor in calculate().
+ * METHOD_MAGNUS is available for the descriptors with linear systems only,
+ * the adaptive METHOD_GBS and METHOD_KUTTA_MERSON take the step of
+ * calculate() as the initial one and control the error with the tolerance of
+ * the job, see catastrophe_abs_tol().
+ */
+enum catastrophe_method_e {
+	METHOD_DEFAULT = 0,
+	METHOD_RK4,
+	METHOD_MAGNUS,
+	METHOD_GBS,
+	METHOD_KUTTA_MERSON,
+};
+
+typedef struct parameter_s          parameter_t;
+typedef enum   catastrophe_type_e   catastrophe_type_t;
+typedef enum   catastrophe_sweep_e  catastrophe_sweep_t;
+typedef enum   catastrophe_method_e catastrophe_method_t;
 
 typedef struct catastrophe_s catastrophe_t;
 
 typedef void (*catastrophe_calculate_t)(catastrophe_t *const catastrophe,
 			const unsigned int i, const unsigned int j);
+typedef void (*catastrophe_initial_t)(catastrophe_t *const catastrophe);
+typedef void (*catastrophe_integrate_t)(const double start, const double end,
+		const double step, catastrophe_t *const catastrophe);
+
+#ifdef CONFIG_CACHE_RESULT
+/*
+ * The results of the points computed by the same sweep and method with the
+ * same tolerance, a job never takes the results of another cache.
+ */
+struct catastrophe_cache {
+	struct catastrophe_cache *next;
+	catastrophe_sweep_t       sweep;
+	catastrophe_method_t      method;
+	/* Tolerance of the job, zero for the default or a fixed step method */
+	double                    tol;
+	void                     *root[CONFIG_CAT_MAX_EQUATIONS];
+	/* Sections of the cache file, found when first used */
+	void                     *file[CONFIG_CAT_MAX_EQUATIONS];
+};
+#endif
 
 typedef struct catastrophe_desc_s catastrophe_desc_t;
 typedef catastrophe_t *(*catastrophe_fabric_t)(catastrophe_desc_t *desc,
@@ -62,11 +117,51 @@ struct catastrophe_desc_s {
 
 	catastrophe_calculate_t calculate;
 
+	/*
+	 * Optional, the number of the independent integrations calculate()
+	 * passes to cmplx_catastrophe_integrate_subs() for a point.
+	 */
+	unsigned int         num_subs;
+
+	/*
+	 * Optional, the method integrating the system of the descriptor with
+	 * the function inlined, see RUNGE_KUTTA_STEPPER().
+	 */
+	catastrophe_integrate_t stepper;
+
+	/* Non-zero if the function is affine in y, see METHOD_MAGNUS */
+	int                  linear;
+
+	/* Optional, the method used unless the job chooses another one */
+	catastrophe_method_t method;
+
+	/*
+	 * Optional, sets the initial vector of the equations. Parameters with
+	 * bits in ray_params enter the equations through PARAM_AT() only, the
+	 * ray sweep and the continuation are allowed for them.
+	 */
+	catastrophe_initial_t initial;
+	unsigned long        ray_params;
+
+	/*
+	 * Optional, the batch function integrated with the step batch_step from
+	 * the initial vector. Must give the same result as calculate().
+	 */
+	union {
+		equation_batch_function_t        real;
+		cmplx_equation_batch_function_t  cmplx;
+	} batch;
+	double               batch_step;
+
+	/* Work of the integrators summed over the jobs of the process */
+	integration_stats_t  stats;
+
 #ifdef CONFIG_CACHE_RESULT
 #ifdef CONFIG_PARALLEL_COMP
 	pthread_spinlock_t cache_root_lock;
 #endif
-	void *cache_root[CONFIG_CAT_MAX_EQUATIONS];
+	/* Caches of the results, added by the jobs and never removed */
+	struct catastrophe_cache *cache;
 #endif
 };
 
@@ -76,15 +171,43 @@ struct catastrophe_s {
 	struct parameter_s    parameter[CONFIG_CAT_MAX_PARAMETERS];
 	unsigned int          num_parameters;
 
+	/* Start of the integration path, zero unless continuing a solution */
+	double                origin[CONFIG_CAT_MAX_PARAMETERS];
+
 	void                 *equation;
 	point_array_t        *point_array;
 	const char           *sym_name;
 
 	catastrophe_calculate_t calculate;
+	/* Integrates the system of the descriptor, chosen by the fabric */
+	catastrophe_integrate_t integrate;
 
 	catastrophe_desc_t   *descriptor;
 
 	unsigned int          deriv;
+
+	catastrophe_sweep_t   sweep;
+	catastrophe_method_t  method;
+	/* Tolerance of the adaptive methods requested by the job, or zero */
+	double                tol;
+	/* Threads requested by the job, zero for all the threads of the pool */
+	unsigned int          num_threads;
+	/* Token shared by the threads of the job, NULL if it cannot be stopped */
+	cancel_token_t       *cancel;
+	/* Nonzero to run the sub-integrations of a point on the pool threads */
+	int                   parallel_subs;
+	/*
+	 * Nonzero if the result must not depend on the number of the threads:
+	 * the tiles are always of CONFIG_TILE_SIZE, the cache is not read.
+	 */
+	int                   deterministic;
+#ifdef CONFIG_CACHE_RESULT
+	/* Cache of the sweep being run, NULL if the results are not cached */
+	struct catastrophe_cache *cache;
+#endif
+
+	/* Work of the integrators, counted by them if CONFIG_INTEGRATION_STATS */
+	integration_stats_t   stats;
 };
 
 /**
@@ -122,11 +245,39 @@ static inline void destruct_catastrophe(catastrophe_t *cat)
 #define catastrophe_set_equation(cat, equ) (cat)->equation = (equ)
 #define catastrophe_set_calculate(cat, calc) \
 	(cat)->calculate = (calc)
+#define catastrophe_set_integrate(cat, integ) \
+	(cat)->integrate = (integ)
 #define catastrophe_set_point_array(cat, point_array) \
 	(cat)->point_array = (point_array)
+#define catastrophe_abs_tol(cat) \
+	((cat)->tol > 0 ? (cat)->tol : CONFIG_INTEGRATION_ABS_TOL)
+#define catastrophe_rel_tol(cat) \
+	((cat)->tol > 0 ? (cat)->tol : CONFIG_INTEGRATION_REL_TOL)
 #define catastrophe_get_real_equation(cat) (cat)->equation
 #define catastrophe_get_cmplx_equation(cat) (cat)->equation
 
+/* Nonzero if the job of the catastrophe is cancelled and must be stopped */
+static inline cancel_reason_t catastrophe_cancelled(catastrophe_t *cat)
+{
+	return cat->cancel ? cancel_token_check(cat->cancel) : CANCEL_NONE;
+}
+
+/*
+ * Nonzero if the job is cancelled, the deadline and the client are not
+ * polled: cheap enough to be checked after every point.
+ */
+static inline cancel_reason_t catastrophe_cancel_reason(catastrophe_t *cat)
+{
+	return cat->cancel ? cancel_token_reason(cat->cancel) : CANCEL_NONE;
+}
+
+static inline void catastrophe_cancel(catastrophe_t *cat,
+		cancel_reason_t reason)
+{
+	if (cat->cancel)
+		cancel_token_trip(cat->cancel, reason);
+}
+
 static inline uint_pair_t
 catastrophe_search_alterable_params(catastrophe_t *cat)
 {
@@ -165,9 +316,17 @@ catastrophe_is_pair_correct(uint_pair_t *pair)
 }
 
 int catastrophe_loop(catastrophe_t *const catastrophe);
+void catastrophe_account_stats(catastrophe_t *const catastrophe);
+void cmplx_catastrophe_integrate_subs(catastrophe_t *const catastrophe,
+		cmplx_equation_t *subs, unsigned int num_subs,
+		const double step);
+int catastrophe_set_method(catastrophe_t *const catastrophe,
+		catastrophe_method_t method);
+int catastrophe_snap_lattice(parameter_t *parameter, int *level);
 
 catastrophe_t *catastrophe_fabric(catastrophe_desc_t *desc,
 		parameter_t *parameter, unsigned int deriv);
+void *catastrophe_construct_equation(catastrophe_desc_t *desc);
 
 void register_catastrophe_desc(catastrophe_desc_t *cd);
 void unregister_catastrophe_desc(catastrophe_desc_t *cd);
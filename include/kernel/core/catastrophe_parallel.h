@@ -4,4 +4,9 @@
 typedef int (*catastrophe_parallel_func_t)(catastrophe_t *catastrophe);
 extern catastrophe_parallel_func_t catastrophe_parallel_loop;
 
+void catastrophe_prepare_params(catastrophe_t *catastrophe,
+		int p1_idx, int p2_idx, int cores);
+int catastrophe_loop_seq(catastrophe_t *catastrophe);
+int catastrophe_loop_smp(catastrophe_t *catastrophe);
+
 #endif /* WAVECAT_CATASTROPHE_PARALLEL_H */
@@ -3,6 +3,8 @@
 
 extern unsigned int cgi_mode;
 extern FILE *out_file_desc;
+/* Socket of the SCGI client being served, -1 in the other modes */
+extern int cgi_client_fd;
 
 #define CGI_ERROR(str)                                      \
 {                                                           \
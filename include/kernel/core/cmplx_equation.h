@@ -12,6 +12,12 @@ struct catastrophe_s;
 typedef void (*cmplx_equation_function_t)(const struct catastrophe_s *const catastrophe,
 		const double t, const complex double *y, complex double *const f);
 
+/* Batch variant of the function, see equation_batch_function_t */
+typedef void (*cmplx_equation_batch_function_t)(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double complex (*y)[CONFIG_BATCH_WIDTH],
+		double complex (*const f)[CONFIG_BATCH_WIDTH]);
+
 struct cmplx_equation_s {
 	cmplx_equation_function_t function;
 	unsigned int num_equations;
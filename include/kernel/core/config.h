@@ -21,13 +21,66 @@
 #define CONFIG_CAT_MAX_EQUATIONS  32
 #define CONFIG_CAT_MAX_STORAGE    32
 
-#define CONFIG_CACHE_MAX_ALLOC    (200 * 1024 * 1024)
+/* Default memory of all the caches, see the --cache-size option */
+#define CONFIG_CACHE_MAX_ALLOC    (200ULL * 1024 * 1024)
+/* Percent of the memory a cache of one derivative may take */
+#define CONFIG_CACHE_QUOTA        50
+/* Percent of the memory or the quota left by the eviction */
+#define CONFIG_CACHE_LOW_WATERMARK 75
+/* The entries of a cache are carved from the chunks of that size */
+#define CONFIG_CACHE_SLAB_SIZE    (2 * 1024 * 1024)
+/* Results a thread computes before adding them to the cache at once */
+#define CONFIG_CACHE_BATCH        256
+/* Mantissa bits of the parameters in the keys and the shards of the hash */
+#define CONFIG_CACHE_HASH_BITS    40
+#define CONFIG_CACHE_HASH_SHARDS  64
+/* Bytes the cache file may grow to, by the steps of CONFIG_CACHE_FILE_GROW */
+#define CONFIG_CACHE_FILE_SIZE    (16ULL * 1024 * 1024 * 1024)
+#define CONFIG_CACHE_FILE_GROW    (4 * 1024 * 1024)
+/* Derivatives of the descriptors the cache file has room for */
+#define CONFIG_CACHE_FILE_SECTIONS 256
+
+/* Points integrated at once by the batch methods: 4 for AVX2, 8 for AVX-512 */
+#define CONFIG_BATCH_WIDTH        4
+
+/* Default tolerances and the step limit of the adaptive integrators */
+#define CONFIG_INTEGRATION_ABS_TOL       1e-8
+#define CONFIG_INTEGRATION_REL_TOL       1e-8
+#define CONFIG_INTEGRATION_MAX_STEPS     100000
+/* Initial step of the integration along a whole ray */
+#define CONFIG_RAY_INITIAL_STEP          0.01
+/* Initial step between neighbouring points and the anchor interval */
+#define CONFIG_CONTINUATION_INITIAL_STEP 0.25
+#define CONFIG_CONTINUATION_ANCHOR       16
+/* The largest linear system integrated by the Magnus method */
+#define CONFIG_MAGNUS_MAX_EQUATIONS      8
+/* Tolerances of the job qualities */
+#define CONFIG_QUALITY_PREVIEW_TOL       1e-6
+#define CONFIG_QUALITY_NORMAL_TOL        1e-8
+#define CONFIG_QUALITY_HIGH_TOL          1e-11
+/* Side of the square tiles of the grid computed by the threads */
+#define CONFIG_TILE_SIZE                 16
+/* Tiles are made smaller until every thread gets that many of them */
+#define CONFIG_TILES_PER_THREAD          4
+/* The largest number of the sub-integrations of a point run at once */
+#define CONFIG_CAT_MAX_SUBS              4
+/* Worker processes of a coordinator and the side of the tiles sent to them */
+#define CONFIG_DIST_MAX_WORKERS          64
+#define CONFIG_DIST_TILE_SIZE            64
+/* A tile is sent to one more worker when it is late by that many times */
+#define CONFIG_DIST_SLOW_FACTOR          4
+/* ... of the mean time of a tile, but at least after the milliseconds */
+#define CONFIG_DIST_SLOW_MIN_MS          1000
 
 /* Define the macro to perform parallel computation */
 #define CONFIG_PARALLEL_COMP
 /* Define the macro to perform profiling */
 #define CONFIG_PROFILING
+/* Define the macro to count the work of the integrators */
+#define CONFIG_INTEGRATION_STATS
 /* Define the macro to perform result caching */
 #define CONFIG_CACHE_RESULT
+/* Define the macro to cache the results in a hash table instead of trees */
+//#define CONFIG_CACHE_HASH
 
 #endif
@@ -11,6 +11,16 @@ struct catastrophe_s;
 typedef void (*equation_function_t)(const struct catastrophe_s *const catastrophe,
 		const double t, const double *y, double *const f);
 
+/*
+ * Batch variant of the function for CONFIG_BATCH_WIDTH points at once. The
+ * arrays are structures of arrays: p[k][w] is the parameter k and y[i][w] is
+ * the component i of the point w, so the loops over w map onto SIMD lanes.
+ */
+typedef void (*equation_batch_function_t)(const double t,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		const double (*y)[CONFIG_BATCH_WIDTH],
+		double (*const f)[CONFIG_BATCH_WIDTH]);
+
 struct equation_s {
 	equation_function_t function;
 	unsigned int num_equations;
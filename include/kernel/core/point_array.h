@@ -3,6 +3,8 @@
 
 #include <kernel/core/config.h>
 #include <stdlib.h>
+#include <stdint.h>
+#include <sys/mman.h>
 
 extern FILE *out_file_desc;
 
@@ -21,10 +23,18 @@ struct point_array_s {
 	double max_y;
 	unsigned int num_steps_y;
 	point_t **array;
+	/* All the points row by row, NULL for a view of another array */
+	point_t *points;
 };
 
 typedef struct point_array_s point_array_t;
 
+/* Bytes of the points of the array */
+static inline size_t point_array_size(point_array_t *pa)
+{
+	return sizeof(*(pa->points)) * pa->num_steps_x * pa->num_steps_y;
+}
+
 static inline point_array_t *construct_point_array(
 		double min_x, double max_x,
 		unsigned int num_steps_x,
@@ -44,41 +54,68 @@ static inline point_array_t *construct_point_array(
 	pa->max_y = max_y;
 	pa->num_steps_y = num_steps_y;
 
+	/*
+	 * The points are mapped afresh, so their pages are first touched by
+	 * the threads computing them and stay on their NUMA nodes. A block of
+	 * the heap may have been touched by the threads of a former job.
+	 */
 	pa->array = malloc(sizeof(*(pa->array)) * num_steps_x);
+	pa->points = mmap(NULL, point_array_size(pa), PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+	if (!pa->array || pa->points == MAP_FAILED) {
+		if (pa->points != MAP_FAILED)
+			munmap(pa->points, point_array_size(pa));
+		free(pa->array);
+		free(pa);
+		return NULL;
+	}
+
 	for (i = 0; i < num_steps_x; i++) {
-		pa->array[i] = malloc(sizeof(**(pa->array)) * num_steps_y);
+		pa->array[i] = pa->points + i * num_steps_y;
 	}
 
 	return pa;
 }
 
-static inline void destruct_point_array(point_array_t *pa)
+/*
+ * point_array_view() - make a point array of a rectangle of another one.
+ *
+ * The view shares the points of the array, rows holds the pointers to its
+ * num_x rows. Nothing is allocated, the view is not destructed.
+ */
+static inline void point_array_view(point_array_t *view, point_t **rows,
+		point_array_t *pa, unsigned int first_x, unsigned int num_x,
+		unsigned int first_y, unsigned int num_y)
 {
+	double step_x = (pa->max_x - pa->min_x) / pa->num_steps_x;
+	double step_y = (pa->max_y - pa->min_y) / pa->num_steps_y;
 	unsigned int i;
 
-	if (!pa)
-		return;
+	assert(first_x + num_x <= pa->num_steps_x);
+	assert(first_y + num_y <= pa->num_steps_y);
 
-	for (i = 0; i < pa->num_steps_x; i++) {
-		free(pa->array[i]);
-	}
+	view->min_x = pa->min_x + first_x * step_x;
+	view->max_x = view->min_x + num_x * step_x;
+	view->num_steps_x = num_x;
+	view->min_y = pa->min_y + first_y * step_y;
+	view->max_y = view->min_y + num_y * step_y;
+	view->num_steps_y = num_y;
+	view->array = rows;
+	view->points = NULL;
 
-	free(pa->array);
-	free(pa);
+	for (i = 0; i < num_x; i++) {
+		rows[i] = pa->array[first_x + i] + first_y;
+	}
 }
 
-static inline void copy_part_point_array(point_array_t *pd, point_array_t *ps,
-		unsigned int first_idx)
+static inline void destruct_point_array(point_array_t *pa)
 {
-	unsigned int i, j, k;
-
-	assert(ps->num_steps_x < pd->num_steps_x);
-	assert(ps->num_steps_y == pd->num_steps_y);
+	if (!pa)
+		return;
 
-	for (i = first_idx, j = 0; j < ps->num_steps_x; i++, j++) {
-		for (k = 0; k < ps->num_steps_y; k++)
-			pd->array[i][k] = ps->array[j][k];
-	}
+	munmap(pa->points, point_array_size(pa));
+	free(pa->array);
+	free(pa);
 }
 
 static inline void point_array_module_print_json(point_array_t *pa)
@@ -151,4 +188,80 @@ static inline void point_array_phase_print_json(point_array_t *pa)
 	fprintf(out_file_desc, "};");
 }
 
+/* FNV-1a hash of the bytes continuing the one of the previous bytes */
+static inline uint64_t point_array_hash(uint64_t hash, const void *data,
+		size_t size)
+{
+	const unsigned char *byte = data;
+
+	while (size--) {
+		hash ^= *byte++;
+		hash *= 1099511628211ULL;
+	}
+
+	return hash;
+}
+
+/*
+ * point_array_tile_checksum() - checksum of the points of a rectangle, both
+ * the modules and the phases, row by row.
+ */
+static inline uint64_t point_array_tile_checksum(point_array_t *pa,
+		unsigned int first_x, unsigned int num_x,
+		unsigned int first_y, unsigned int num_y)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	unsigned int i;
+
+	for (i = first_x; i < first_x + num_x; i++)
+		hash = point_array_hash(hash, &pa->array[i][first_y],
+				num_y * sizeof(point_t));
+
+	return hash;
+}
+
+/*
+ * point_array_digest_print_json() - print the checksums of the tiles of the
+ * given side in the row-major order and the digest of the whole array made
+ * of them.
+ */
+static inline void point_array_digest_print_json(point_array_t *pa,
+		unsigned int tile_size)
+{
+	uint64_t digest = 14695981039346656037ULL, sum;
+	unsigned int x, y, num_x, num_y;
+	uint32_t header[3];
+
+	header[0] = pa->num_steps_x;
+	header[1] = pa->num_steps_y;
+	header[2] = tile_size;
+	digest = point_array_hash(digest, header, sizeof(header));
+
+	fprintf(out_file_desc, "\nexperimentDigest = {\n");
+	fprintf(out_file_desc, "tileSize : %u,\n", tile_size);
+	fprintf(out_file_desc, "tiles : [");
+
+	for (x = 0; x < pa->num_steps_x; x += tile_size) {
+		num_x = pa->num_steps_x - x < tile_size ?
+			pa->num_steps_x - x : tile_size;
+		for (y = 0; y < pa->num_steps_y; y += tile_size) {
+			num_y = pa->num_steps_y - y < tile_size ?
+				pa->num_steps_y - y : tile_size;
+
+			sum = point_array_tile_checksum(pa, x, num_x, y, num_y);
+			digest = point_array_hash(digest, &sum, sizeof(sum));
+
+			if (x || y)
+				fprintf(out_file_desc, ", ");
+			fprintf(out_file_desc, "\"%016llx\"",
+					(unsigned long long) sum);
+		}
+	}
+
+	fprintf(out_file_desc, "],\n");
+	fprintf(out_file_desc, "digest : \"%016llx\"\n",
+			(unsigned long long) digest);
+	fprintf(out_file_desc, "};");
+}
+
 #endif /* _WAVECAT_POINT_ARRAY_H_ */
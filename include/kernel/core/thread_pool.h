@@ -0,0 +1,27 @@
+#ifndef _WAVECAT_THREAD_POOL_H_
+#define _WAVECAT_THREAD_POOL_H_
+
+typedef long (*thread_pool_func_t)(void *arg);
+
+/*
+ * Placement of the threads on the CPUs. COMPACT fills the CPUs of a NUMA node
+ * before the next one, SCATTER spreads the threads over the nodes in turn.
+ */
+enum thread_pool_affinity_e {
+	AFFINITY_NONE = 0,
+	AFFINITY_COMPACT,
+	AFFINITY_SCATTER,
+};
+
+typedef enum thread_pool_affinity_e thread_pool_affinity_t;
+
+unsigned int thread_pool_detect_size(void);
+int thread_pool_set_affinity(thread_pool_affinity_t affinity);
+int thread_pool_start(unsigned int num_threads);
+void thread_pool_stop(void);
+unsigned int thread_pool_size(void);
+unsigned int thread_pool_self(void);
+int thread_pool_run(thread_pool_func_t func, void **args, long *results,
+		unsigned int num_items, unsigned int max_threads);
+
+#endif /* _WAVECAT_THREAD_POOL_H_ */
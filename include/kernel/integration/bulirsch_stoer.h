@@ -0,0 +1,15 @@
+#ifndef _LIB_INTEGRATION_BULIRSCH_STOER_H_
+#define _LIB_INTEGRATION_BULIRSCH_STOER_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/equation.h>
+#include <kernel/integration/stats.h>
+
+int bulirsch_stoer_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats);
+
+void bulirsch_stoer(const double start, const double end, const double step,
+		catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_BULIRSCH_STOER_H_ */
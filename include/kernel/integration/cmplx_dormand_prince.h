@@ -0,0 +1,24 @@
+#ifndef _LIB_INTEGRATION_CMPLX_DORMAND_PRINCE_H_
+#define _LIB_INTEGRATION_CMPLX_DORMAND_PRINCE_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/cmplx_equation.h>
+#include <kernel/integration/stats.h>
+
+#include <complex.h>
+
+int cmplx_dormand_prince_dense(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats,
+		const double *dense_t, const unsigned int num_dense,
+		double complex (*dense_vector)[CONFIG_CAT_MAX_EQUATIONS],
+		unsigned int *num_saved);
+
+int cmplx_dormand_prince_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats);
+
+void cmplx_dormand_prince(const double start, const double end,
+		const double step, catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_CMPLX_DORMAND_PRINCE_H_ */
@@ -0,0 +1,17 @@
+#ifndef _LIB_INTEGRATION_CMPLX_KUTTA_MERSON_H_
+#define _LIB_INTEGRATION_CMPLX_KUTTA_MERSON_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/cmplx_equation.h>
+#include <kernel/integration/stats.h>
+
+#include <complex.h>
+
+int cmplx_kutta_merson_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats);
+
+void cmplx_kutta_merson(const double start, const double end,
+		const double step, catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_CMPLX_KUTTA_MERSON_H_ */
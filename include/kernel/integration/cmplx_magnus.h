@@ -0,0 +1,12 @@
+#ifndef _LIB_INTEGRATION_CMPLX_MAGNUS_H_
+#define _LIB_INTEGRATION_CMPLX_MAGNUS_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/cmplx_equation.h>
+
+#include <complex.h>
+
+void cmplx_magnus(const double start, const double end, const double step,
+		catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_CMPLX_MAGNUS_H_ */
@@ -0,0 +1,105 @@
+#ifndef _LIB_INTEGRATION_DORMAND_PRINCE_TABLEAU_H_
+#define _LIB_INTEGRATION_DORMAND_PRINCE_TABLEAU_H_
+
+/*
+ * Butcher tableau of the Dormand-Prince 5(4) pair shared by the real and the
+ * complex integrators. The 7th stage is evaluated at the new point, so it is
+ * reused as the 1st stage of the next step (FSAL).
+ */
+
+#define DP_C2 (1.0 / 5.0)
+#define DP_C3 (3.0 / 10.0)
+#define DP_C4 (4.0 / 5.0)
+#define DP_C5 (8.0 / 9.0)
+
+#define DP_A21 (1.0 / 5.0)
+
+#define DP_A31 (3.0 / 40.0)
+#define DP_A32 (9.0 / 40.0)
+
+#define DP_A41 (44.0 / 45.0)
+#define DP_A42 (-56.0 / 15.0)
+#define DP_A43 (32.0 / 9.0)
+
+#define DP_A51 (19372.0 / 6561.0)
+#define DP_A52 (-25360.0 / 2187.0)
+#define DP_A53 (64448.0 / 6561.0)
+#define DP_A54 (-212.0 / 729.0)
+
+#define DP_A61 (9017.0 / 3168.0)
+#define DP_A62 (-355.0 / 33.0)
+#define DP_A63 (46732.0 / 5247.0)
+#define DP_A64 (49.0 / 176.0)
+#define DP_A65 (-5103.0 / 18656.0)
+
+/* Weights of the 5th order solution (also the 7th row of the tableau) */
+#define DP_B1 (35.0 / 384.0)
+#define DP_B3 (500.0 / 1113.0)
+#define DP_B4 (125.0 / 192.0)
+#define DP_B5 (-2187.0 / 6784.0)
+#define DP_B6 (11.0 / 84.0)
+
+/* Difference between the 5th and the embedded 4th order weights */
+#define DP_E1 (71.0 / 57600.0)
+#define DP_E3 (-71.0 / 16695.0)
+#define DP_E4 (71.0 / 1920.0)
+#define DP_E5 (-17253.0 / 339200.0)
+#define DP_E6 (22.0 / 525.0)
+#define DP_E7 (-1.0 / 40.0)
+
+/*
+ * Continuous extension of the 4th order. The solution inside the step is
+ * y(t + theta * h) = y + h * sum(w_i(theta) * k_i), where w_i is a polynomial
+ * of theta without a free term with the coefficients below.
+ */
+#define DP_D11 1.0
+#define DP_D12 (-8048581381.0 / 2820520608.0)
+#define DP_D13 (8663915743.0 / 2820520608.0)
+#define DP_D14 (-12715105075.0 / 11282082432.0)
+
+#define DP_D32 (131558114200.0 / 32700410799.0)
+#define DP_D33 (-68118460800.0 / 10900136933.0)
+#define DP_D34 (87487479700.0 / 32700410799.0)
+
+#define DP_D42 (-1754552775.0 / 470086768.0)
+#define DP_D43 (14199869525.0 / 1410260304.0)
+#define DP_D44 (-10690763975.0 / 1880347072.0)
+
+#define DP_D52 (127303824393.0 / 49829197408.0)
+#define DP_D53 (-318862633887.0 / 49829197408.0)
+#define DP_D54 (701980252875.0 / 199316789632.0)
+
+#define DP_D62 (-282668133.0 / 205662961.0)
+#define DP_D63 (2019193451.0 / 616988883.0)
+#define DP_D64 (-1453857185.0 / 822651844.0)
+
+#define DP_D72 (40617522.0 / 29380423.0)
+#define DP_D73 (-110615467.0 / 29380423.0)
+#define DP_D74 (69997945.0 / 29380423.0)
+
+/*
+ * dp_dense_weights() - weights of the stages for the point theta of the step,
+ * the weight of the 2nd stage is always zero and is not computed.
+ */
+static inline void dp_dense_weights(const double theta, double *const w1,
+		double *const w3, double *const w4, double *const w5,
+		double *const w6, double *const w7)
+{
+	const double t2 = theta * theta;
+	const double t3 = t2 * theta;
+	const double t4 = t3 * theta;
+
+	*w1 = DP_D11 * theta + DP_D12 * t2 + DP_D13 * t3 + DP_D14 * t4;
+	*w3 = DP_D32 * t2 + DP_D33 * t3 + DP_D34 * t4;
+	*w4 = DP_D42 * t2 + DP_D43 * t3 + DP_D44 * t4;
+	*w5 = DP_D52 * t2 + DP_D53 * t3 + DP_D54 * t4;
+	*w6 = DP_D62 * t2 + DP_D63 * t3 + DP_D64 * t4;
+	*w7 = DP_D72 * t2 + DP_D73 * t3 + DP_D74 * t4;
+}
+
+/* Step size controller */
+#define DP_SAFETY     0.9
+#define DP_MIN_FACTOR 0.2
+#define DP_MAX_FACTOR 5.0
+
+#endif /* _LIB_INTEGRATION_DORMAND_PRINCE_TABLEAU_H_ */
@@ -0,0 +1,15 @@
+#ifndef _LIB_INTEGRATION_KUTTA_MERSON_H_
+#define _LIB_INTEGRATION_KUTTA_MERSON_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/equation.h>
+#include <kernel/integration/stats.h>
+
+int kutta_merson_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats);
+
+void kutta_merson(const double start, const double end, const double step,
+		catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_KUTTA_MERSON_H_ */
@@ -0,0 +1,10 @@
+#ifndef _LIB_INTEGRATION_MAGNUS_H_
+#define _LIB_INTEGRATION_MAGNUS_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/equation.h>
+
+void magnus(const double start, const double end, const double step,
+		catastrophe_t *const cat);
+
+#endif /* _LIB_INTEGRATION_MAGNUS_H_ */
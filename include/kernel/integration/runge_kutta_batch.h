@@ -0,0 +1,13 @@
+#ifndef _LIB_INTEGRATION_RUNGE_KUTTA_BATCH_H_
+#define _LIB_INTEGRATION_RUNGE_KUTTA_BATCH_H_
+
+#include <kernel/core/config.h>
+#include <kernel/core/equation.h>
+
+unsigned long runge_kutta_batch(const double start, const double end,
+		const double step, equation_batch_function_t function,
+		const unsigned int num_equations,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		double (*y)[CONFIG_BATCH_WIDTH]);
+
+#endif /* _LIB_INTEGRATION_RUNGE_KUTTA_BATCH_H_ */
@@ -0,0 +1,95 @@
+#ifndef _LIB_INTEGRATION_RUNGE_KUTTA_FIXED_H_
+#define _LIB_INTEGRATION_RUNGE_KUTTA_FIXED_H_
+
+#include <kernel/core/catastrophe.h>
+#include <kernel/core/equation.h>
+
+/*
+ * RUNGE_KUTTA_FIXED_DEFINE() - define the classical Runge-Kutta method for a
+ * system of exactly n equations with the interface of runge_kutta().
+ *
+ * The steps and the order of the operations are the same as in
+ * runge_kutta(). The size is a constant, so the loops are unrolled and the
+ * state is kept in registers. If func is a function defined in the same
+ * file, it is called directly and inlined (flatten).
+ */
+#define RUNGE_KUTTA_FIXED_DEFINE(storage, name, equation_type, type,	\
+		n, func)						\
+storage void __attribute__ ((flatten)) name(const double start,	\
+		const double end, const double step,			\
+		catastrophe_t *const cat)				\
+{									\
+	equation_type *equation;					\
+									\
+	type k1[(n)], k2[(n)], k3[(n)], k4[(n)];			\
+	type  y[(n)], y1[(n)];						\
+									\
+	double t, cur_t;						\
+	unsigned long steps = 0;					\
+	unsigned int i;							\
+									\
+	equation = cat->equation;					\
+									\
+	for (i = 0; i < (n); i++) {					\
+		y[i] = equation->initial_vector[i];			\
+	}								\
+									\
+	t = start;							\
+									\
+	while (t < end - step) {					\
+		cur_t = t;						\
+		func(cat, cur_t, y, k1);				\
+		for (i = 0; i < (n); i++) {				\
+			k1[i] = k1[i] * step;				\
+			y1[i] = y[i] + k1[i] / 2.0;			\
+		}							\
+		cur_t = t + step / 2.0;					\
+		func(cat, cur_t, y1, k2);				\
+		for (i = 0; i < (n); i++) {				\
+			k2[i] = k2[i] * step;				\
+			y1[i] = y[i] + k2[i] / 2.0;			\
+		}							\
+		cur_t = t + step / 2.0;					\
+		func(cat, cur_t, y1, k3);				\
+		for (i = 0; i < (n); i++) {				\
+			k3[i] = k3[i] * step;				\
+			y1[i] = y[i] + k3[i];				\
+		}							\
+		cur_t = t + step;					\
+		func(cat, cur_t, y1, k4);				\
+		for (i = 0; i < (n); i++) {				\
+			k4[i] = k4[i] * step;				\
+			y[i] = y[i] +					\
+				(k1[i] + 2.0 * k2[i] + 2.0 * k3[i] +	\
+				 k4[i]) / 6.0;				\
+		}							\
+									\
+		t += step;						\
+		steps++;						\
+	}								\
+									\
+	for (i = 0; i < (n); i++) {					\
+		equation->resulting_vector[i] = y[i];			\
+	}								\
+									\
+	INTEGRATION_STATS_ADD(&cat->stats, 1, steps, 0, 4 * steps);	\
+}
+
+/*
+ * RUNGE_KUTTA_STEPPER() - define the stepper of a descriptor for its system
+ * of n real equations computed by func. The function must not write f and
+ * read y beyond n components.
+ */
+#define RUNGE_KUTTA_STEPPER(name, func, n) \
+	RUNGE_KUTTA_FIXED_DEFINE(static, name, equation_t, double, n, func)
+
+/* The same for the systems of complex equations */
+#define CMPLX_RUNGE_KUTTA_STEPPER(name, func, n) \
+	RUNGE_KUTTA_FIXED_DEFINE(static, name, cmplx_equation_t, \
+			double complex, n, func)
+
+catastrophe_integrate_t runge_kutta_fixed(const unsigned int num_equations);
+catastrophe_integrate_t cmplx_runge_kutta_fixed(
+		const unsigned int num_equations);
+
+#endif /* _LIB_INTEGRATION_RUNGE_KUTTA_FIXED_H_ */
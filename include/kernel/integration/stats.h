@@ -0,0 +1,45 @@
+#ifndef _LIB_INTEGRATION_STATS_H_
+#define _LIB_INTEGRATION_STATS_H_
+
+#include <kernel/core/config.h>
+
+/*
+ * Work done by the integrators: during one call of an adaptive one, or summed
+ * over the calls in the counters of catastrophes and descriptors. Fixed-step
+ * methods accept every step they take and never reject one.
+ */
+struct integration_stats {
+	unsigned long integrations;
+	unsigned long accepted;
+	unsigned long rejected;
+	unsigned long evaluations;
+};
+
+typedef struct integration_stats integration_stats_t;
+
+/*
+ * INTEGRATION_STATS_ADD() - account num integrations with acc accepted and
+ * rej rejected steps and evals evaluations of the function in total.
+ */
+#ifdef CONFIG_INTEGRATION_STATS
+#define INTEGRATION_STATS_ADD(stats, num, acc, rej, evals) do {	\
+	(stats)->integrations += (num);				\
+	(stats)->accepted     += (acc);				\
+	(stats)->rejected     += (rej);				\
+	(stats)->evaluations  += (evals);			\
+} while (0)
+#else
+#define INTEGRATION_STATS_ADD(stats, num, acc, rej, evals) do {	\
+	(void) (stats); (void) (num); (void) (acc);		\
+	(void) (rej); (void) (evals);				\
+} while (0)
+#endif
+
+static inline void integration_stats_merge(integration_stats_t *to,
+		const integration_stats_t *from)
+{
+	INTEGRATION_STATS_ADD(to, from->integrations, from->accepted,
+			from->rejected, from->evaluations);
+}
+
+#endif /* _LIB_INTEGRATION_STATS_H_ */
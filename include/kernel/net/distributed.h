@@ -0,0 +1,57 @@
+#ifndef _WAVECAT_DISTRIBUTED_H_
+#define _WAVECAT_DISTRIBUTED_H_
+
+#include <kernel/core/catastrophe.h>
+#include <stdint.h>
+
+#define DIST_MAGIC   0x57434154 /* "WCAT" */
+#define DIST_VERSION 2
+
+/*
+ * The messages are the structures below in the byte order of the host, the
+ * coordinator and the workers are the same build on the same architecture.
+ * The magic number of the other byte order is rejected.
+ */
+
+/* A parameter of the tile, the varying ones cover the tile only */
+struct dist_param {
+	double   cur_value;
+	double   min_value;
+	double   max_value;
+	double   step_size;
+	uint32_t num_steps;
+	char     sym_name[MAX_NAME_LEN];
+};
+
+/* Followed by num_parameters of struct dist_param */
+struct dist_request {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t tile;
+	uint32_t num_parameters;
+	uint32_t deriv;
+	uint32_t sweep;
+	uint32_t method;
+	uint32_t deterministic;
+	double   tol;
+	char     name[MAX_NAME_LEN];
+};
+
+/* Followed by num_x * num_y points of the tile row by row on success */
+struct dist_response {
+	uint32_t magic;
+	uint32_t tile;
+	int32_t  status;
+	uint32_t num_x;
+	uint32_t num_y;
+	uint64_t integrations;
+	uint64_t accepted;
+	uint64_t rejected;
+	uint64_t evaluations;
+};
+
+int distributed_set_workers(const char *addresses);
+int catastrophe_loop_distributed(catastrophe_t *catastrophe);
+int distributed_worker(const char *address);
+
+#endif /* _WAVECAT_DISTRIBUTED_H_ */
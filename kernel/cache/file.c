@@ -0,0 +1,557 @@
+/**
+ * kernel/cache/file.c - results kept in a file mapped by the processes.
+ *
+ * NOTES:
+ *
+ * The file starts with a header: the magic, the version of the format, the
+ * sizes it was made with and the table of the sections. A section keeps the
+ * results of a derivative of a descriptor, it is found by the name, the type
+ * and the derivative of the descriptor, the number of the parameters and the
+ * hash of their names, and by the sweep, the method and the tolerance the
+ * results are computed with. A descriptor changing its parameters gets a new
+ * section, a file of another version or machine is not used at all.
+ *
+ * The file only grows. A result is appended as a record of the point and the
+ * values of the parameters, then an open-addressing index of the section
+ * gets the offset of the record. An index filled by half is replaced by the
+ * one twice as large appended the same way, the old one stays in the file.
+ *
+ * The writers of all the processes are serialized by flock() on the file,
+ * the threads of a process by a mutex besides. The writer extends the file
+ * before using the new bytes and publishes a record, an index or a section
+ * by the release store of its offset or number, so the readers take no lock
+ * and see either nothing or the complete data. A writer killed in the middle
+ * leaves the bytes it appended unused, nothing else.
+ */
+
+#include <kernel/core/config.h>
+#include <kernel/cache/file.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/file.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+#define CACHE_FILE_MAGIC     "WAVECAT"
+#define CACHE_FILE_VERSION   2
+#define CACHE_FILE_ENDIAN    0x01020304U
+#define CACHE_FILE_MIN_SLOTS 1024
+
+struct cache_file_slot {
+	uint64_t hash;
+	/* Offset of the record, zero for an empty slot */
+	uint64_t record;
+};
+
+struct cache_file_index {
+	uint64_t               num_slots;
+	uint64_t               unused;
+	struct cache_file_slot slot[];
+};
+
+struct cache_file_record {
+	point_t point;
+	double  parameter[];
+};
+
+struct cache_file_section {
+	char     name[32];
+	uint32_t type;
+	uint32_t deriv;
+	uint32_t num_parameters;
+	/* Sweep and method the results are computed by */
+	uint16_t sweep;
+	uint16_t method;
+	/* Tolerance of the method, zero for the default one */
+	double   tol;
+	/* Hash of the names of the parameters */
+	uint64_t schema;
+	/* Offset of the current index */
+	uint64_t index;
+	uint64_t count;
+};
+
+struct cache_file_header {
+	char     magic[8];
+	uint32_t version;
+	uint32_t endian;
+	uint32_t header_size;
+	uint32_t max_sections;
+	/* Bytes used, the new records and indexes are appended there */
+	uint64_t size;
+	uint32_t num_sections;
+	uint32_t unused;
+	struct cache_file_section section[CONFIG_CACHE_FILE_SECTIONS];
+};
+
+static pthread_mutex_t cache_file_mutex = PTHREAD_MUTEX_INITIALIZER;
+static struct cache_file_header *map = NULL;
+static int cache_file_fd = -1;
+static int writable = 0;
+/* Bytes of the file known to exist */
+static uint64_t file_length = 0;
+
+static void *cache_file_at(uint64_t offset)
+{
+	return (char *) map + offset;
+}
+
+static uint64_t cache_file_hash(const double *parameter, unsigned int num)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	uint64_t bits;
+	double value;
+	unsigned int i;
+
+	for (i = 0; i < num; i++) {
+		/* Zeroes of both signs are the same key */
+		value = parameter[i] + 0.0;
+		memcpy(&bits, &value, sizeof(bits));
+		hash = (hash ^ bits) * 1099511628211ULL;
+		hash ^= hash >> 32;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+static uint64_t cache_file_schema(char **par_names, unsigned int num)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	const char *c;
+	unsigned int i;
+
+	for (i = 0; i < num; i++) {
+		/* The terminating zero separates the names */
+		c = par_names[i];
+		do {
+			hash = (hash ^ (unsigned char) *c) * 1099511628211ULL;
+		} while (*c++);
+	}
+
+	return hash;
+}
+
+/*
+ * cache_file_append() - take the bytes at the end of the used part of the
+ * file, extending the file if needed. The writer lock must be held.
+ *
+ * Returns the offset of the bytes, or zero if the file is full.
+ */
+static uint64_t cache_file_append(uint64_t bytes)
+{
+	uint64_t offset = (map->size + 7) & ~7ULL;
+	uint64_t length;
+	struct stat st;
+
+	if (offset + bytes > CONFIG_CACHE_FILE_SIZE)
+		return 0;
+
+	if (offset + bytes > file_length) {
+		/* Another process may have extended it */
+		if (fstat(cache_file_fd, &st)) {
+			perror("[error] Cannot stat cache file");
+			return 0;
+		}
+		file_length = st.st_size;
+	}
+
+	if (offset + bytes > file_length) {
+		length = (offset + bytes + CONFIG_CACHE_FILE_GROW - 1) /
+			CONFIG_CACHE_FILE_GROW * CONFIG_CACHE_FILE_GROW;
+		if (length > CONFIG_CACHE_FILE_SIZE)
+			length = CONFIG_CACHE_FILE_SIZE;
+		if (ftruncate(cache_file_fd, length)) {
+			perror("[error] Cannot extend cache file");
+			return 0;
+		}
+		file_length = length;
+	}
+
+	map->size = offset + bytes;
+
+	return offset;
+}
+
+static void cache_file_place(struct cache_file_index *index, uint64_t hash,
+		uint64_t record)
+{
+	uint64_t pos, mask = index->num_slots - 1;
+
+	pos = hash & mask;
+	while (index->slot[pos].record)
+		pos = (pos + 1) & mask;
+
+	__atomic_store_n(&index->slot[pos].hash, hash, __ATOMIC_RELAXED);
+	__atomic_store_n(&index->slot[pos].record, record, __ATOMIC_RELEASE);
+}
+
+/*
+ * cache_file_grow() - give the section a new index of the size with all the
+ * records of the old one. The writer lock must be held.
+ */
+static int cache_file_grow(struct cache_file_section *section,
+		uint64_t num_slots)
+{
+	struct cache_file_index *index, *old = NULL;
+	uint64_t offset, i;
+
+	offset = cache_file_append(sizeof(*index) +
+			num_slots * sizeof(index->slot[0]));
+	if (!offset)
+		return -1;
+
+	index = cache_file_at(offset);
+	index->num_slots = num_slots;
+
+	if (section->index)
+		old = cache_file_at(section->index);
+	for (i = 0; old && i < old->num_slots; i++)
+		if (old->slot[i].record)
+			cache_file_place(index, old->slot[i].hash,
+					old->slot[i].record);
+
+	__atomic_store_n(&section->index, offset, __ATOMIC_RELEASE);
+
+	return 0;
+}
+
+static int cache_file_check(void)
+{
+	struct stat st;
+
+	if (fstat(cache_file_fd, &st) || (uint64_t) st.st_size < sizeof(*map))
+		return -1;
+	file_length = st.st_size;
+
+	if (memcmp(map->magic, CACHE_FILE_MAGIC, sizeof(map->magic)) ||
+	    map->version != CACHE_FILE_VERSION ||
+	    map->endian != CACHE_FILE_ENDIAN ||
+	    map->header_size != sizeof(*map) ||
+	    map->max_sections != CONFIG_CACHE_FILE_SECTIONS ||
+	    map->num_sections > CONFIG_CACHE_FILE_SECTIONS)
+		return -1;
+
+	return 0;
+}
+
+/**
+ * cache_file_open() - map the cache file, created if missing
+ * @path path to the file
+ *
+ * The file is only read if it cannot be written. On error the results are
+ * not kept in any file.
+ *
+ * Returns 0 on success and -1 on error.
+ */
+int cache_file_open(const char *path)
+{
+	struct stat st;
+	int prot = PROT_READ;
+
+	cache_file_fd = open(path, O_RDWR | O_CREAT, 0644);
+	if (cache_file_fd >= 0) {
+		writable = 1;
+		prot |= PROT_WRITE;
+	} else {
+		cache_file_fd = open(path, O_RDONLY);
+	}
+	if (cache_file_fd < 0) {
+		perror("[error] Cannot open cache file");
+		return -1;
+	}
+
+	/* The first writer creates the header */
+	if (flock(cache_file_fd, writable ? LOCK_EX : LOCK_SH)) {
+		perror("[error] Cannot lock cache file");
+		goto error_lock;
+	}
+
+	if (fstat(cache_file_fd, &st)) {
+		perror("[error] Cannot stat cache file");
+		goto error_map;
+	}
+
+	if (writable && !st.st_size &&
+	    ftruncate(cache_file_fd, CONFIG_CACHE_FILE_GROW)) {
+		perror("[error] Cannot extend cache file");
+		goto error_map;
+	}
+
+	map = mmap(NULL, CONFIG_CACHE_FILE_SIZE, prot, MAP_SHARED,
+			cache_file_fd, 0);
+	if (map == MAP_FAILED) {
+		map = NULL;
+		perror("[error] Cannot map cache file");
+		goto error_map;
+	}
+
+	if (writable && !st.st_size) {
+		map->version = CACHE_FILE_VERSION;
+		map->endian = CACHE_FILE_ENDIAN;
+		map->header_size = sizeof(*map);
+		map->max_sections = CONFIG_CACHE_FILE_SECTIONS;
+		map->size = sizeof(*map);
+		/* The magic is the last, the header is valid with it only */
+		memcpy(map->magic, CACHE_FILE_MAGIC, sizeof(map->magic));
+	}
+
+	if (cache_file_check()) {
+		fprintf(stderr, "[error] Cache file %s is of another format\n",
+				path);
+		goto error_check;
+	}
+
+	flock(cache_file_fd, LOCK_UN);
+
+	return 0;
+
+error_check:
+	munmap(map, CONFIG_CACHE_FILE_SIZE);
+	map = NULL;
+error_map:
+	flock(cache_file_fd, LOCK_UN);
+error_lock:
+	close(cache_file_fd);
+	cache_file_fd = -1;
+	writable = 0;
+	return -1;
+}
+
+static struct cache_file_section *cache_file_lookup(const char *name,
+		unsigned int type, unsigned int deriv,
+		unsigned int num_parameters, uint64_t schema,
+		unsigned int sweep, unsigned int method, double tol)
+{
+	struct cache_file_section *section;
+	uint32_t i, num;
+
+	num = __atomic_load_n(&map->num_sections, __ATOMIC_ACQUIRE);
+	for (i = 0; i < num; i++) {
+		section = &map->section[i];
+		if (section->type == type && section->deriv == deriv &&
+		    section->num_parameters == num_parameters &&
+		    section->schema == schema &&
+		    section->sweep == sweep && section->method == method &&
+		    section->tol == tol &&
+		    !strncmp(section->name, name, sizeof(section->name)))
+			return section;
+	}
+
+	return NULL;
+}
+
+/**
+ * cache_file_section() - find the section of a derivative of a descriptor
+ * @name           symbolic name of the descriptor
+ * @type           type of the descriptor
+ * @deriv          the derivative
+ * @num_parameters number of the parameters of the descriptor
+ * @par_names      names of the parameters
+ * @sweep          sweep the results are computed by
+ * @method         method the results are computed by
+ * @tol            tolerance of the method, zero for the default one
+ * @create         non-zero to create the missing section
+ *
+ * Returns the section, or NULL if it is missing, or if it is to be created
+ * and the file is not open for writing.
+ */
+struct cache_file_section *cache_file_section(const char *name,
+		unsigned int type, unsigned int deriv,
+		unsigned int num_parameters, char **par_names,
+		unsigned int sweep, unsigned int method, double tol,
+		int create)
+{
+	static unsigned int full_logged;
+	struct cache_file_section *section;
+	uint64_t schema;
+	uint32_t num;
+
+	if (!map || (create && !writable))
+		return NULL;
+
+	schema = cache_file_schema(par_names, num_parameters);
+
+	section = cache_file_lookup(name, type, deriv, num_parameters, schema,
+			sweep, method, tol);
+	if (section || !create)
+		return section;
+
+	cache_file_lock();
+
+	/* Another writer may have created it */
+	section = cache_file_lookup(name, type, deriv, num_parameters, schema,
+			sweep, method, tol);
+	if (section)
+		goto out;
+
+	num = map->num_sections;
+	if (num == CONFIG_CACHE_FILE_SECTIONS) {
+		/* Said once, the file stays full until it is removed */
+		if (!full_logged++)
+			fprintf(stderr, "[error] Cache file is full, the "
+					"results of %s are not kept\n", name);
+		goto out;
+	}
+
+	section = &map->section[num];
+	memset(section, 0, sizeof(*section));
+	strncpy(section->name, name, sizeof(section->name) - 1);
+	section->type = type;
+	section->deriv = deriv;
+	section->num_parameters = num_parameters;
+	section->schema = schema;
+	section->sweep = sweep;
+	section->method = method;
+	section->tol = tol;
+
+	if (cache_file_grow(section, CACHE_FILE_MIN_SLOTS)) {
+		section = NULL;
+		goto out;
+	}
+
+	__atomic_store_n(&map->num_sections, num + 1, __ATOMIC_RELEASE);
+
+out:
+	cache_file_unlock();
+
+	return section;
+}
+
+static struct cache_file_record *cache_file_find(
+		struct cache_file_section *section, uint64_t hash,
+		const double *parameter, unsigned int num)
+{
+	struct cache_file_index *index;
+	struct cache_file_record *record;
+	uint64_t pos, mask, offset;
+	unsigned int i;
+
+	index = cache_file_at(__atomic_load_n(&section->index,
+				__ATOMIC_ACQUIRE));
+	mask = index->num_slots - 1;
+
+	for (pos = hash & mask;; pos = (pos + 1) & mask) {
+		offset = __atomic_load_n(&index->slot[pos].record,
+				__ATOMIC_ACQUIRE);
+		if (!offset)
+			return NULL;
+		if (__atomic_load_n(&index->slot[pos].hash,
+					__ATOMIC_RELAXED) != hash)
+			continue;
+
+		record = cache_file_at(offset);
+		for (i = 0; i < num; i++)
+			if (record->parameter[i] != parameter[i])
+				break;
+		if (i == num)
+			return record;
+	}
+}
+
+/**
+ * cache_file_search() - look for the result with the parameters of the key
+ * @section the section of the results
+ * @key     the result with the parameters set
+ *
+ * Takes no lock.
+ *
+ * Returns 1 and sets the point of the key if the result is found, 0
+ * otherwise.
+ */
+int cache_file_search(struct cache_file_section *section,
+		struct cached_result *key)
+{
+	struct cache_file_record *record;
+
+	record = cache_file_find(section,
+			cache_file_hash(key->parameter, key->num_parameters),
+			key->parameter, key->num_parameters);
+	if (!record)
+		return 0;
+
+	key->point = record->point;
+
+	return 1;
+}
+
+/**
+ * cache_file_lock() - become the writer of the file
+ */
+void cache_file_lock(void)
+{
+	if (!writable)
+		return;
+
+	pthread_mutex_lock(&cache_file_mutex);
+	flock(cache_file_fd, LOCK_EX);
+}
+
+/**
+ * cache_file_unlock() - let other writers in
+ */
+void cache_file_unlock(void)
+{
+	if (!writable)
+		return;
+
+	flock(cache_file_fd, LOCK_UN);
+	pthread_mutex_unlock(&cache_file_mutex);
+}
+
+/**
+ * cache_file_save() - append a result to the section
+ * @section the section created by cache_file_section()
+ * @result  the result with the point and the parameters set
+ *
+ * The caller must hold the lock of cache_file_lock().
+ *
+ * Returns 0 if the result is added, 1 if the section already has such a
+ * result and -1 on error.
+ */
+int cache_file_save(struct cache_file_section *section,
+		struct cached_result *result)
+{
+	struct cache_file_index *index;
+	struct cache_file_record *record;
+	uint64_t hash, offset;
+
+	if (!writable)
+		return -1;
+
+	index = cache_file_at(section->index);
+	if ((section->count + 1) * 2 > index->num_slots) {
+		if (cache_file_grow(section, index->num_slots * 2))
+			return -1;
+		index = cache_file_at(section->index);
+	}
+
+	hash = cache_file_hash(result->parameter, result->num_parameters);
+	if (cache_file_find(section, hash, result->parameter,
+				result->num_parameters))
+		return 1;
+
+	offset = cache_file_append(sizeof(*record) +
+			result->num_parameters * sizeof(record->parameter[0]));
+	if (!offset)
+		return -1;
+
+	record = cache_file_at(offset);
+	record->point = result->point;
+	memcpy(record->parameter, result->parameter,
+			result->num_parameters * sizeof(record->parameter[0]));
+
+	cache_file_place(index, hash, offset);
+	section->count++;
+
+	return 0;
+}
@@ -0,0 +1,386 @@
+/**
+ * kernel/cache/hash.c - results of all the caches in one hash table.
+ *
+ * NOTES:
+ *
+ * The table is addressed openly and cut into the shards by the high bits
+ * of the hash. A key is the root of the cache, a descriptor and a
+ * derivative, with the values of the parameters. The values are quantized
+ * to CONFIG_CACHE_HASH_BITS bits of the mantissa, so the ones differing in
+ * the last bits only are the same key.
+ *
+ * A slot keeps the hash of its key next to the pointer to the result, a
+ * probe looks at the result only when the hashes are equal. The writers of
+ * a shard hold its lock, the results are carved from the slab of their root
+ * under the lock of the root. A slot is filled by the release store of the
+ * pointer after its hash, so the readers take no lock and see either an
+ * empty slot or a complete one. The full table of a shard is replaced by a
+ * larger one published the same way, the old one is freed by
+ * simple_cache_reclaim() when no job is running.
+ */
+
+#include <kernel/core/config.h>
+#include <kernel/cache/simple.h>
+#include <kernel/cache/slab.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#ifdef CONFIG_CACHE_HASH
+
+#define CACHE_HASH_MIN_SIZE 256
+
+struct cache_hash_slot {
+	uint64_t              hash;
+	struct cached_result *result;
+};
+
+struct cache_hash_table {
+	/* Next of the tables waiting for simple_cache_reclaim() */
+	struct cache_hash_table *next;
+	unsigned long            mask;
+	unsigned long            count;
+	struct cache_hash_slot   slot[];
+};
+
+struct cache_hash_shard {
+	pthread_spinlock_t       lock;
+	struct cache_hash_table *table;
+} __attribute__ ((aligned (64)));
+
+static struct cache_hash_shard shards[CONFIG_CACHE_HASH_SHARDS];
+
+/* Kept in the root of a cache */
+struct cache_hash_root {
+	struct cache_slab        slab;
+};
+
+static pthread_mutex_t retired_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct cache_hash_table *retired = NULL;
+
+static uint64_t cache_hash_quantize(double value)
+{
+	uint64_t bits;
+
+	/* Zeroes of both signs are the same value */
+	value += 0.0;
+	memcpy(&bits, &value, sizeof(bits));
+
+	/* The carry out of the mantissa goes to the exponent */
+	bits += 1ULL << (51 - CONFIG_CACHE_HASH_BITS);
+	bits &= ~((1ULL << (52 - CONFIG_CACHE_HASH_BITS)) - 1);
+
+	return bits;
+}
+
+static uint64_t cache_hash_key(void **root, const struct cached_result *key)
+{
+	uint64_t hash = (uintptr_t) root;
+	unsigned int i;
+
+	for (i = 0; i < key->num_parameters; i++) {
+		hash ^= cache_hash_quantize(key->parameter[i]);
+		hash *= 0x9e3779b97f4a7c15ULL;
+		hash ^= hash >> 29;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+
+	/* Zero is the hash of an empty slot */
+	return hash ? hash : 1;
+}
+
+static int cache_hash_equal(void **root, const struct cached_result *result,
+		const struct cached_result *key)
+{
+	unsigned int i;
+
+	if (result->root != root ||
+	    result->num_parameters != key->num_parameters)
+		return 0;
+
+	for (i = 0; i < key->num_parameters; i++)
+		if (cache_hash_quantize(result->parameter[i]) !=
+		    cache_hash_quantize(key->parameter[i]))
+			return 0;
+
+	return 1;
+}
+
+static struct cache_hash_shard *cache_hash_shard(uint64_t hash)
+{
+	return &shards[(hash >> 48) % CONFIG_CACHE_HASH_SHARDS];
+}
+
+static struct cache_hash_table *cache_hash_alloc(unsigned long size)
+{
+	struct cache_hash_table *table;
+
+	table = calloc(1, sizeof(*table) + size * sizeof(table->slot[0]));
+	if (!table)
+		return NULL;
+
+	table->mask = size - 1;
+
+	return table;
+}
+
+static void cache_hash_place(struct cache_hash_table *table, uint64_t hash,
+		struct cached_result *result)
+{
+	unsigned long pos;
+
+	pos = hash & table->mask;
+	while (table->slot[pos].result)
+		pos = (pos + 1) & table->mask;
+
+	__atomic_store_n(&table->slot[pos].hash, hash, __ATOMIC_RELAXED);
+	__atomic_store_n(&table->slot[pos].result, result, __ATOMIC_RELEASE);
+	table->count++;
+}
+
+static struct cached_result *cache_hash_find(struct cache_hash_table *table,
+		uint64_t hash, void **root, struct cached_result *key)
+{
+	struct cached_result *result;
+	unsigned long pos;
+
+	if (!table)
+		return NULL;
+
+	pos = hash & table->mask;
+	for (;;) {
+		result = __atomic_load_n(&table->slot[pos].result,
+				__ATOMIC_ACQUIRE);
+		if (!result)
+			return NULL;
+		if (__atomic_load_n(&table->slot[pos].hash,
+					__ATOMIC_RELAXED) == hash &&
+		    cache_hash_equal(root, result, key))
+			return result;
+		pos = (pos + 1) & table->mask;
+	}
+}
+
+/*
+ * cache_hash_grow() - replace the table of the shard by the one twice as
+ * large, the lock of the shard must be held.
+ */
+static int cache_hash_grow(struct cache_hash_shard *shard)
+{
+	struct cache_hash_table *table = shard->table, *grown;
+	unsigned long i;
+
+	grown = cache_hash_alloc(table ? (table->mask + 1) * 2 :
+			CACHE_HASH_MIN_SIZE);
+	if (!grown) {
+		perror("[error] Cannot allocate cache table");
+		return -1;
+	}
+
+	for (i = 0; table && i <= table->mask; i++)
+		if (table->slot[i].result)
+			cache_hash_place(grown, table->slot[i].hash,
+					table->slot[i].result);
+
+	__atomic_store_n(&shard->table, grown, __ATOMIC_RELEASE);
+
+	if (table) {
+		pthread_mutex_lock(&retired_lock);
+		table->next = retired;
+		retired = table;
+		pthread_mutex_unlock(&retired_lock);
+	}
+
+	return 0;
+}
+
+/*
+ * simple_cache_save_result() - put a copy of the key in the cache of the
+ * root.
+ *
+ * The lock of the root must be held. Returns 0 if the result is added, 1 if
+ * the cache already has such a result and -1 on error.
+ */
+int simple_cache_save_result(void **root, struct cached_result *key)
+{
+	uint64_t hash = cache_hash_key(root, key);
+	struct cache_hash_shard *shard = cache_hash_shard(hash);
+	struct cache_hash_root *cache = *root;
+	struct cache_hash_table *table;
+	struct cached_result *result;
+	size_t size = cached_result_size(key->num_parameters);
+	int ret = 0;
+
+	if (!cache) {
+		cache = calloc(1, sizeof(*cache));
+		if (!cache) {
+			perror("[error] Cannot allocate cache root");
+			return -1;
+		}
+		cache_slab_init(&cache->slab, cache);
+		*root = cache;
+	}
+
+	pthread_spin_lock(&shard->lock);
+
+	if (cache_hash_find(shard->table, hash, root, key)) {
+		ret = 1;
+		goto out;
+	}
+
+	table = shard->table;
+	if (!table || (table->count + 1) * 2 > table->mask + 1) {
+		if (cache_hash_grow(shard)) {
+			ret = -1;
+			goto out;
+		}
+	}
+
+	result = cache_slab_alloc(&cache->slab, size);
+	if (!result) {
+		ret = -1;
+		goto out;
+	}
+
+	memcpy(result, key, size);
+	result->root = root;
+	result->clock = 0;
+
+	cache_hash_place(shard->table, hash, result);
+
+out:
+	pthread_spin_unlock(&shard->lock);
+
+	return ret;
+}
+
+/*
+ * simple_cache_search_result() - look for the result with the parameters of
+ * the key, takes no lock.
+ */
+struct cached_result *simple_cache_search_result(void **root,
+		struct cached_result *result)
+{
+	uint64_t hash = cache_hash_key(root, result);
+	struct cache_hash_shard *shard = cache_hash_shard(hash);
+	struct cached_result *found;
+
+	found = cache_hash_find(__atomic_load_n(&shard->table, __ATOMIC_ACQUIRE),
+			hash, root, result);
+	if (found)
+		cached_result_touch(found);
+
+	return found;
+}
+
+/*
+ * cache_hash_remove() - empty the slot, the following slots of the run are
+ * shifted back to keep them reachable. No job may be running.
+ */
+static void cache_hash_remove(struct cache_hash_table *table,
+		unsigned long pos)
+{
+	unsigned long next = pos, home;
+
+	for (;;) {
+		table->slot[pos].hash = 0;
+		table->slot[pos].result = NULL;
+
+		for (;;) {
+			next = (next + 1) & table->mask;
+			if (!table->slot[next].result) {
+				table->count--;
+				return;
+			}
+
+			/* The result stays if its home is between the two */
+			home = table->slot[next].hash & table->mask;
+			if (pos <= next ? (pos < home && home <= next) :
+					  (pos < home || home <= next))
+				continue;
+
+			table->slot[pos] = table->slot[next];
+			pos = next;
+			break;
+		}
+	}
+}
+
+/* cache_hash_evicted() - whether the slab of the result is being compacted */
+static int cache_hash_evicted(struct cached_result *result)
+{
+	struct cache_hash_root *cache = *result->root;
+
+	return cache->slab.evicted;
+}
+
+/* cache_hash_add() - put the moved result back to the table */
+static void cache_hash_add(struct cache_slab *slab,
+		struct cached_result *result)
+{
+	uint64_t hash = cache_hash_key(result->root, result);
+	struct cache_hash_shard *shard = cache_hash_shard(hash);
+	struct cache_hash_table *table = shard->table;
+
+	(void) slab;
+
+	if (!table || (table->count + 1) * 2 > table->mask + 1) {
+		if (cache_hash_grow(shard))
+			return;
+	}
+
+	cache_hash_place(shard->table, hash, result);
+}
+
+/*
+ * simple_cache_reclaim() - evict the results out of the budget and free the
+ * tables replaced by the larger ones, called between the jobs.
+ *
+ * The results of the slabs with evicted ones leave the tables and come back
+ * from the compacted slabs.
+ */
+void simple_cache_reclaim(void)
+{
+	struct cache_hash_table *table;
+	struct cache_slab *slab;
+	unsigned long pos;
+	unsigned int i;
+
+	if (cache_slab_evict()) {
+		for (i = 0; i < CONFIG_CACHE_HASH_SHARDS; i++) {
+			table = shards[i].table;
+			for (pos = 0; table && pos <= table->mask; pos++)
+				while (table->slot[pos].result &&
+				       cache_hash_evicted(table->slot[pos].result))
+					cache_hash_remove(table, pos);
+		}
+
+		for (slab = cache_slab_next(NULL); slab;
+		     slab = cache_slab_next(slab))
+			if (slab->evicted)
+				cache_slab_compact(slab, cache_hash_add);
+	}
+
+	pthread_mutex_lock(&retired_lock);
+	while (retired) {
+		table = retired;
+		retired = table->next;
+		free(table);
+	}
+	pthread_mutex_unlock(&retired_lock);
+}
+
+static void cache_hash_init(void) __attribute__((constructor));
+static void cache_hash_init(void)
+{
+	unsigned int i;
+
+	for (i = 0; i < CONFIG_CACHE_HASH_SHARDS; i++)
+		pthread_spin_init(&shards[i].lock, PTHREAD_PROCESS_PRIVATE);
+}
+
+#endif /* CONFIG_CACHE_HASH */
@@ -0,0 +1,203 @@
+/**
+ * kernel/cache/index.c - index of the results of a cache for the readers.
+ *
+ * NOTES:
+ *
+ * The results are looked up by all the threads of a job, and added in
+ * batches by one thread at a time holding the lock of the cache. The index
+ * is an open-addressing table of pointers to the results, which are not
+ * changed once added. A slot is filled by the release store of the pointer,
+ * so a reader sees either an empty slot or a complete result and takes no
+ * lock.
+ *
+ * A table filled by half is replaced by the one twice as large, published
+ * the same way. The readers may still look at the old table, it is freed by
+ * cache_index_reclaim() when no job is running.
+ */
+
+#include <kernel/core/config.h>
+#include <kernel/cache/index.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define CACHE_INDEX_MIN_SIZE 1024
+
+struct cache_index {
+	/* Next of the tables waiting for cache_index_reclaim() */
+	struct cache_index    *next;
+	unsigned long          mask;
+	unsigned long          count;
+	struct cached_result  *slot[];
+};
+
+static pthread_mutex_t retired_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct cache_index *retired = NULL;
+
+static unsigned long cache_index_hash(const struct cached_result *key)
+{
+	uint64_t hash = 14695981039346656037ULL;
+	uint64_t bits;
+	double value;
+	unsigned int i;
+
+	for (i = 0; i < key->num_parameters; i++) {
+		/* Zeroes of both signs are the same key */
+		value = key->parameter[i] + 0.0;
+		memcpy(&bits, &value, sizeof(bits));
+		hash = (hash ^ bits) * 1099511628211ULL;
+		hash ^= hash >> 32;
+	}
+
+	hash ^= hash >> 33;
+	hash *= 0xff51afd7ed558ccdULL;
+	hash ^= hash >> 33;
+
+	return hash;
+}
+
+static int cache_index_equal(const struct cached_result *left,
+		const struct cached_result *right)
+{
+	unsigned int i;
+
+	if (left->num_parameters != right->num_parameters)
+		return 0;
+
+	for (i = 0; i < left->num_parameters; i++)
+		if (left->parameter[i] != right->parameter[i])
+			return 0;
+
+	return 1;
+}
+
+static struct cache_index *cache_index_alloc(unsigned long size)
+{
+	struct cache_index *table;
+
+	table = calloc(1, sizeof(*table) + size * sizeof(table->slot[0]));
+	if (!table)
+		return NULL;
+
+	table->mask = size - 1;
+
+	return table;
+}
+
+static void cache_index_place(struct cache_index *table,
+		struct cached_result *result)
+{
+	unsigned long pos;
+
+	pos = cache_index_hash(result) & table->mask;
+	while (table->slot[pos])
+		pos = (pos + 1) & table->mask;
+
+	__atomic_store_n(&table->slot[pos], result, __ATOMIC_RELEASE);
+	table->count++;
+}
+
+/**
+ * cache_index_search() - look for the result with the parameters of the key
+ * @index pointer to the index of a cache
+ * @key   the result with the parameters set
+ *
+ * Takes no lock and may be called along with cache_index_insert().
+ *
+ * Returns the result found or NULL.
+ */
+struct cached_result *cache_index_search(struct cache_index **index,
+		struct cached_result *key)
+{
+	struct cache_index *table;
+	struct cached_result *result;
+	unsigned long pos;
+
+	table = __atomic_load_n(index, __ATOMIC_ACQUIRE);
+	if (!table)
+		return NULL;
+
+	pos = cache_index_hash(key) & table->mask;
+	for (;;) {
+		result = __atomic_load_n(&table->slot[pos], __ATOMIC_ACQUIRE);
+		if (!result)
+			return NULL;
+		if (cache_index_equal(result, key))
+			return result;
+		pos = (pos + 1) & table->mask;
+	}
+}
+
+/**
+ * cache_index_insert() - add a result missing in the index
+ * @index  pointer to the index of a cache
+ * @result the result, not changed afterwards
+ *
+ * The lock of the cache must be held.
+ *
+ * Returns 0 on success and -1 if a larger table cannot be allocated.
+ */
+int cache_index_insert(struct cache_index **index,
+		struct cached_result *result)
+{
+	struct cache_index *table = *index, *grown;
+	unsigned long i;
+
+	if (!table || (table->count + 1) * 2 > table->mask + 1) {
+		grown = cache_index_alloc(table ? (table->mask + 1) * 2 :
+				CACHE_INDEX_MIN_SIZE);
+		if (!grown) {
+			perror("[error] Cannot allocate cache index");
+			return -1;
+		}
+
+		for (i = 0; table && i <= table->mask; i++)
+			if (table->slot[i])
+				cache_index_place(grown, table->slot[i]);
+
+		__atomic_store_n(index, grown, __ATOMIC_RELEASE);
+
+		if (table) {
+			pthread_mutex_lock(&retired_lock);
+			table->next = retired;
+			retired = table;
+			pthread_mutex_unlock(&retired_lock);
+		}
+		table = grown;
+	}
+
+	cache_index_place(table, result);
+
+	return 0;
+}
+
+/**
+ * cache_index_reclaim() - free the tables replaced by the larger ones
+ *
+ * Must be called when no thread searches the caches, between the jobs.
+ */
+void cache_index_reclaim(void)
+{
+	struct cache_index *table;
+
+	pthread_mutex_lock(&retired_lock);
+	while (retired) {
+		table = retired;
+		retired = table->next;
+		free(table);
+	}
+	pthread_mutex_unlock(&retired_lock);
+}
+
+/**
+ * cache_index_destroy() - free the index of a cache
+ * @index pointer to the index of a cache
+ *
+ * Must be called when no thread searches the caches, between the jobs.
+ */
+void cache_index_destroy(struct cache_index **index)
+{
+	free(*index);
+	*index = NULL;
+}
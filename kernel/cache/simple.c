@@ -1,11 +1,26 @@
+#define _GNU_SOURCE
+
 #include <kernel/core/config.h>
 #include <kernel/cache/simple.h>
+#include <kernel/cache/index.h>
+#include <kernel/cache/slab.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <search.h>
 #include <pthread.h>
 
-static unsigned int allocated_bytes = 0;
+#ifndef CONFIG_CACHE_HASH
+/*
+ * The results of a root are carved from its slab. They are kept in a tree,
+ * which drops the duplicates, and in the index read by the threads without
+ * a lock.
+ */
+struct simple_cache_root {
+	void               *tree;
+	struct cache_index *index;
+	struct cache_slab   slab;
+};
 
 static int compare(const void *l, const void *r)
 {
@@ -24,11 +39,31 @@ static int compare(const void *l, const void *r)
 	return 0;
 }
 
-int simple_cache_save_result(void **root, struct cached_result *result)
+/*
+ * simple_cache_save_result() - put a copy of the key in the cache of the
+ * root.
+ *
+ * The lock of the root must be held. Returns 0 if the result is added, 1 if
+ * the cache already has such a result and -1 on error.
+ */
+int simple_cache_save_result(void **root, struct cached_result *key)
 {
+	struct simple_cache_root *cache = *root;
+	struct cached_result *result;
+	size_t size = cached_result_size(key->num_parameters);
 	void *val;
 
-	val = tsearch(result, root, compare);
+	if (!cache) {
+		cache = calloc(1, sizeof(*cache));
+		if (!cache) {
+			perror("[error] Cannot allocate cache root");
+			return -1;
+		}
+		cache_slab_init(&cache->slab, cache);
+		__atomic_store_n(root, cache, __ATOMIC_RELEASE);
+	}
+
+	val = tsearch(key, &cache->tree, compare);
 	if (!val) {
 		perror("[error] incorrect return value from tsearch()");
 		return -1;
@@ -38,43 +73,91 @@ int simple_cache_save_result(void **root, struct cached_result *result)
 	 * Specially handle the situation when the cache already has such
 	 * result.
 	 */
-	if (*((struct cached_result **)val) != result)
-		free(result);
+	if (*((struct cached_result **)val) != key)
+		return 1;
+
+	/* The node is given the copy of the key equal to it */
+	result = cache_slab_alloc(&cache->slab, size);
+	if (!result) {
+		tdelete(key, &cache->tree, compare);
+		return -1;
+	}
+
+	memcpy(result, key, size);
+	result->clock = 0;
+	*((struct cached_result **)val) = result;
+
+	cache_index_insert(&cache->index, result);
 
 	return 0;
 }
 
+/*
+ * simple_cache_search_result() - look for the result with the parameters of
+ * the key, takes no lock.
+ */
 struct cached_result *simple_cache_search_result(void **root,
 		struct cached_result *result)
 {
-	void *ret;
+	struct simple_cache_root *cache;
+	struct cached_result *found;
 
-	ret = tfind(result, root, compare);
-	if (!ret)
+	cache = __atomic_load_n(root, __ATOMIC_ACQUIRE);
+	if (!cache)
 		return NULL;
 
-	return *((struct cached_result **) ret);
+	found = cache_index_search(&cache->index, result);
+	if (found)
+		cached_result_touch(found);
+
+	return found;
 }
 
-struct cached_result *simple_cache_cached_result_alloc(void)
+static void simple_cache_keep(void *node)
 {
-	struct cached_result *result;
-	unsigned int checked_bytes;
+	(void) node;
+}
 
-	checked_bytes = __sync_fetch_and_add(&allocated_bytes, sizeof(*result));
-	if (checked_bytes >= CONFIG_CACHE_MAX_ALLOC) {
-		checked_bytes = __sync_fetch_and_sub(&allocated_bytes,
-				sizeof(*result));
-		return NULL;
-	}
+/* simple_cache_add() - put the moved result back to its cache */
+static void simple_cache_add(struct cache_slab *slab,
+		struct cached_result *result)
+{
+	struct simple_cache_root *cache = slab->owner;
 
-	result = malloc(sizeof(*result));
-	if (!result) {
-		checked_bytes = __sync_fetch_and_sub(&allocated_bytes,
-				sizeof(*result));
-		perror("[error] Cannot allocate cached result object");
-		return NULL;
+	if (!tsearch(result, &cache->tree, compare)) {
+		perror("[error] incorrect return value from tsearch()");
+		return;
 	}
 
-	return result;
+	cache_index_insert(&cache->index, result);
+}
+
+/*
+ * simple_cache_reclaim() - free the memory the readers may have still used
+ * and evict the results out of the budget, called between the jobs.
+ *
+ * The caches with evicted results are rebuilt from their compacted slabs.
+ */
+void simple_cache_reclaim(void)
+{
+	struct simple_cache_root *cache;
+	struct cache_slab *slab;
+
+	cache_index_reclaim();
+
+	if (!cache_slab_evict())
+		return;
+
+	for (slab = cache_slab_next(NULL); slab; slab = cache_slab_next(slab)) {
+		if (!slab->evicted)
+			continue;
+
+		cache = slab->owner;
+		tdestroy(cache->tree, simple_cache_keep);
+		cache->tree = NULL;
+		cache_index_destroy(&cache->index);
+
+		cache_slab_compact(slab, simple_cache_add);
+	}
 }
+#endif /* CONFIG_CACHE_HASH */
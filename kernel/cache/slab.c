@@ -0,0 +1,367 @@
+/**
+ * kernel/cache/slab.c - chunks of memory the entries of the caches are
+ * carved from.
+ *
+ * NOTES:
+ *
+ * A chunk is of CONFIG_CACHE_SLAB_SIZE bytes. It is taken from the reserved
+ * huge pages when the system has them, otherwise it is aligned to its size
+ * and given to the transparent huge pages. All the chunks of the process are
+ * counted against the budget, CONFIG_CACHE_MAX_ALLOC unless set by
+ * simple_cache_set_budget(), and the chunks of a slab against its quota,
+ * CONFIG_CACHE_QUOTA percent of the budget.
+ *
+ * The readers of the caches take no lock, so an entry is never freed while
+ * a job is running: a cache out of its memory refuses the new entries until
+ * the job ends. Then cache_slab_evict() sweeps the entries with a CLOCK,
+ * down to CONFIG_CACHE_LOW_WATERMARK percent of the quota or the budget. A
+ * new entry has its clock at zero and is evicted at the first sweep unless
+ * it is hit, every hit saves it for one more sweep. The global sweep visits
+ * the slabs in turn, a chunk of entries at a time, so the slabs of the cold
+ * catastrophes give their memory to the hot ones.
+ */
+
+#define _GNU_SOURCE
+
+#include <kernel/core/config.h>
+#include <kernel/cache/slab.h>
+#include <sys/mman.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+struct cache_chunk {
+	struct cache_chunk *next;
+	/* Bytes of the entries carved */
+	size_t              used;
+	int                 mapped;
+	double              data[];
+};
+
+#define CACHE_CHUNK_ROOM (CONFIG_CACHE_SLAB_SIZE - sizeof(struct cache_chunk))
+/* Clock of an evicted entry */
+#define CACHE_SLAB_DEAD  (~0U)
+
+static pthread_mutex_t slabs_lock = PTHREAD_MUTEX_INITIALIZER;
+static struct cache_slab *slabs = NULL;
+/* Slab the global sweep continues from */
+static struct cache_slab *slab_hand = NULL;
+
+static uint64_t budget = CONFIG_CACHE_MAX_ALLOC;
+static uint64_t allocated_bytes = 0;
+/* A chunk was refused for the budget since the last eviction */
+static int budget_refused = 0;
+
+static uint64_t cache_slab_quota(void)
+{
+	return budget / 100 * CONFIG_CACHE_QUOTA;
+}
+
+static struct cache_chunk *cache_slab_chunk(struct cache_slab *slab)
+{
+	struct cache_chunk *chunk;
+	uint64_t checked_bytes;
+	void *mem;
+
+	if ((slab->num_chunks + 1) * CONFIG_CACHE_SLAB_SIZE >
+	    cache_slab_quota()) {
+		slab->refused = 1;
+		return NULL;
+	}
+
+	checked_bytes = __sync_fetch_and_add(&allocated_bytes,
+			CONFIG_CACHE_SLAB_SIZE);
+	if (checked_bytes + CONFIG_CACHE_SLAB_SIZE > budget) {
+		__sync_fetch_and_sub(&allocated_bytes, CONFIG_CACHE_SLAB_SIZE);
+		__atomic_store_n(&budget_refused, 1, __ATOMIC_RELAXED);
+		return NULL;
+	}
+
+#ifdef MAP_HUGETLB
+	mem = mmap(NULL, CONFIG_CACHE_SLAB_SIZE, PROT_READ | PROT_WRITE,
+			MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+	if (mem != MAP_FAILED) {
+		chunk = mem;
+		chunk->mapped = 1;
+		goto out;
+	}
+#endif
+
+	if (posix_memalign(&mem, CONFIG_CACHE_SLAB_SIZE,
+				CONFIG_CACHE_SLAB_SIZE)) {
+		__sync_fetch_and_sub(&allocated_bytes, CONFIG_CACHE_SLAB_SIZE);
+		perror("[error] Cannot allocate cache slab");
+		return NULL;
+	}
+
+#ifdef MADV_HUGEPAGE
+	madvise(mem, CONFIG_CACHE_SLAB_SIZE, MADV_HUGEPAGE);
+#endif
+
+	chunk = mem;
+	chunk->mapped = 0;
+
+#ifdef MAP_HUGETLB
+out:
+#endif
+	chunk->next = NULL;
+	chunk->used = 0;
+	slab->num_chunks++;
+
+	return chunk;
+}
+
+static void cache_slab_free_chunk(struct cache_slab *slab,
+		struct cache_chunk *chunk)
+{
+	if (chunk->mapped)
+		munmap(chunk, CONFIG_CACHE_SLAB_SIZE);
+	else
+		free(chunk);
+
+	__sync_fetch_and_sub(&allocated_bytes, CONFIG_CACHE_SLAB_SIZE);
+	slab->num_chunks--;
+}
+
+/**
+ * cache_slab_init() - prepare the zeroed slab and add it to the slabs of
+ * the process
+ * @slab  pointer to the slab
+ * @owner cache the slab belongs to
+ */
+void cache_slab_init(struct cache_slab *slab, void *owner)
+{
+	slab->owner = owner;
+
+	pthread_mutex_lock(&slabs_lock);
+	slab->next = slabs;
+	slabs = slab;
+	pthread_mutex_unlock(&slabs_lock);
+}
+
+/**
+ * cache_slab_alloc() - carve an entry from the slab
+ * @slab pointer to the slab
+ * @size size of the entry, the same for all the entries of the slab
+ *
+ * Returns the entry, or NULL if the memory of the caches or the quota of
+ * the slab is exhausted.
+ */
+void *cache_slab_alloc(struct cache_slab *slab, size_t size)
+{
+	struct cache_chunk *chunk = slab->last;
+	void *entry;
+
+	if (!slab->entry_size)
+		slab->entry_size = size;
+	if (size != slab->entry_size || size > CACHE_CHUNK_ROOM)
+		return NULL;
+
+	if (!chunk || chunk->used + size > CACHE_CHUNK_ROOM) {
+		chunk = cache_slab_chunk(slab);
+		if (!chunk)
+			return NULL;
+
+		if (slab->last)
+			slab->last->next = chunk;
+		else
+			slab->first = chunk;
+		slab->last = chunk;
+	}
+
+	entry = (char *) chunk->data + chunk->used;
+	chunk->used += size;
+	slab->num_entries++;
+
+	return entry;
+}
+
+/**
+ * cache_slab_next() - iterate over the slabs of the process
+ * @slab the previous slab, NULL for the first one
+ *
+ * Must be called when no job is running.
+ */
+struct cache_slab *cache_slab_next(struct cache_slab *slab)
+{
+	return slab ? slab->next : slabs;
+}
+
+/* cache_slab_needed() - chunks the live entries of the slab would fill */
+static uint64_t cache_slab_needed(struct cache_slab *slab)
+{
+	uint64_t per_chunk;
+
+	if (!slab->num_entries)
+		return 0;
+
+	per_chunk = CACHE_CHUNK_ROOM / slab->entry_size;
+
+	return (slab->num_entries + per_chunk - 1) / per_chunk;
+}
+
+/*
+ * cache_slab_sweep() - move the hand of the CLOCK past the next entry of the
+ * slab, which is evicted if no hit saved it since the last sweep. The slab
+ * must have live entries.
+ */
+static void cache_slab_sweep(struct cache_slab *slab)
+{
+	struct cached_result *entry;
+
+	if (!slab->hand || slab->hand_pos >= slab->hand->used) {
+		slab->hand = (slab->hand && slab->hand->next) ?
+			slab->hand->next : slab->first;
+		slab->hand_pos = 0;
+	}
+
+	entry = (struct cached_result *)
+		((char *) slab->hand->data + slab->hand_pos);
+	slab->hand_pos += slab->entry_size;
+
+	if (entry->clock == CACHE_SLAB_DEAD)
+		return;
+
+	if (entry->clock) {
+		entry->clock--;
+		return;
+	}
+
+	entry->clock = CACHE_SLAB_DEAD;
+	slab->num_entries--;
+	slab->evicted = 1;
+}
+
+/**
+ * cache_slab_evict() - evict the entries of the slabs out of their quota,
+ * then of all the slabs if the budget is exhausted
+ *
+ * Must be called when no job is running. The evicted entries stay in their
+ * chunks until cache_slab_compact() is called for each slab evicted.
+ *
+ * Returns 1 if some entries are evicted, 0 otherwise.
+ */
+int cache_slab_evict(void)
+{
+	uint64_t quota = cache_slab_quota() / CONFIG_CACHE_SLAB_SIZE;
+	uint64_t target, total = 0, needed, k;
+	struct cache_slab *slab;
+	int evicted = 0;
+
+	for (slab = slabs; slab; slab = slab->next) {
+		if (slab->refused || slab->num_chunks > quota) {
+			target = quota * CONFIG_CACHE_LOW_WATERMARK / 100;
+			while (cache_slab_needed(slab) > target)
+				cache_slab_sweep(slab);
+		}
+		slab->refused = 0;
+		total += cache_slab_needed(slab);
+	}
+
+	if (budget_refused || allocated_bytes > budget) {
+		target = budget / CONFIG_CACHE_SLAB_SIZE *
+			CONFIG_CACHE_LOW_WATERMARK / 100;
+
+		slab = slab_hand;
+		while (total > target) {
+			if (!slab)
+				slab = slabs;
+
+			needed = cache_slab_needed(slab);
+			for (k = 0; slab->num_entries &&
+			     k < CACHE_CHUNK_ROOM / slab->entry_size; k++)
+				cache_slab_sweep(slab);
+			total -= needed - cache_slab_needed(slab);
+
+			slab = slab->next;
+		}
+		slab_hand = slab;
+	}
+	budget_refused = 0;
+
+	for (slab = slabs; slab; slab = slab->next)
+		evicted |= slab->evicted;
+
+	return evicted;
+}
+
+/**
+ * cache_slab_compact() - move the live entries of the slab to its first
+ * chunks and free the rest
+ * @slab pointer to the slab
+ * @add  called for each live entry at its new place
+ *
+ * Must be called when no job is running, the owner must forget all the
+ * entries of the slab before.
+ */
+void cache_slab_compact(struct cache_slab *slab,
+		void (*add)(struct cache_slab *slab,
+			struct cached_result *entry))
+{
+	struct cache_chunk *src, *dst = slab->first, *next, *hand = NULL;
+	struct cached_result *entry, *moved;
+	size_t pos, dst_pos = 0, hand_pos = 0;
+
+	for (src = slab->first; src; src = src->next) {
+		for (pos = 0; pos < src->used; pos += slab->entry_size) {
+			/* The hand stays at the same entry */
+			if (src == slab->hand && pos == slab->hand_pos) {
+				hand = dst;
+				hand_pos = dst_pos;
+			}
+
+			entry = (struct cached_result *)
+				((char *) src->data + pos);
+			if (entry->clock == CACHE_SLAB_DEAD)
+				continue;
+
+			if (dst_pos + slab->entry_size > CACHE_CHUNK_ROOM) {
+				dst->used = dst_pos;
+				dst = dst->next;
+				dst_pos = 0;
+			}
+
+			moved = (struct cached_result *)
+				((char *) dst->data + dst_pos);
+			if (moved != entry)
+				memcpy(moved, entry, slab->entry_size);
+			dst_pos += slab->entry_size;
+
+			add(slab, moved);
+		}
+	}
+
+	if (slab->num_entries) {
+		dst->used = dst_pos;
+		src = dst->next;
+		dst->next = NULL;
+		slab->last = dst;
+	} else {
+		src = slab->first;
+		slab->first = NULL;
+		slab->last = NULL;
+		hand = NULL;
+	}
+
+	for (; src; src = next) {
+		next = src->next;
+		cache_slab_free_chunk(slab, src);
+	}
+
+	slab->hand = hand;
+	slab->hand_pos = hand_pos;
+	slab->evicted = 0;
+}
+
+/**
+ * simple_cache_set_budget() - set the memory of all the caches
+ * @bytes the budget in bytes
+ *
+ * Must be called when no job is running. A smaller budget is reached at the
+ * end of the next job.
+ */
+void simple_cache_set_budget(uint64_t bytes)
+{
+	budget = bytes;
+}
@@ -0,0 +1,89 @@
+/**
+ * kernel/core/cancel.c - cooperative cancellation of the jobs.
+ *
+ * NOTES:
+ *
+ * A job is cancelled when a point diverges, when the time limit of the job
+ * is over, or when the SCGI client has gone away. The first reason tripping
+ * the token is kept, so the job is reported by what has really stopped it.
+ */
+
+#define _GNU_SOURCE
+
+#include <kernel/core/cancel.h>
+
+#include <poll.h>
+#include <string.h>
+
+/**
+ * cancel_token_init() - prepare the token of a job
+ * @token     pointer to the token
+ * @client_fd socket of the SCGI client, -1 if there is no client
+ * @timeout   time limit of the job in seconds, zero if there is no limit
+ */
+void cancel_token_init(cancel_token_t *token, int client_fd, double timeout)
+{
+	memset(token, 0, sizeof(*token));
+	token->client_fd = client_fd;
+
+	if (timeout > 0) {
+		clock_gettime(CLOCK_MONOTONIC, &token->deadline);
+		token->deadline.tv_sec  += (time_t) timeout;
+		token->deadline.tv_nsec += (long) ((timeout - (time_t) timeout) *
+				1e9);
+		if (token->deadline.tv_nsec >= 1000000000L) {
+			token->deadline.tv_sec++;
+			token->deadline.tv_nsec -= 1000000000L;
+		}
+	}
+}
+
+/**
+ * cancel_token_trip() - cancel the job
+ * @token  pointer to the token
+ * @reason why the job is cancelled, ignored if it is already cancelled
+ */
+void cancel_token_trip(cancel_token_t *token, cancel_reason_t reason)
+{
+	int none = CANCEL_NONE;
+
+	__atomic_compare_exchange_n(&token->reason, &none, reason, 0,
+			__ATOMIC_RELAXED, __ATOMIC_RELAXED);
+}
+
+/**
+ * cancel_token_check() - check whether the job must be stopped
+ * @token pointer to the token
+ *
+ * Trips the token if the deadline has passed or the client has closed the
+ * connection.
+ *
+ * Returns the reason of the cancellation, CANCEL_NONE to go on.
+ */
+cancel_reason_t cancel_token_check(cancel_token_t *token)
+{
+	struct timespec now;
+	struct pollfd pfd;
+
+	if (cancel_token_reason(token))
+		return cancel_token_reason(token);
+
+	if (token->deadline.tv_sec || token->deadline.tv_nsec) {
+		clock_gettime(CLOCK_MONOTONIC, &now);
+		if (now.tv_sec > token->deadline.tv_sec ||
+				(now.tv_sec == token->deadline.tv_sec &&
+				 now.tv_nsec >= token->deadline.tv_nsec))
+			cancel_token_trip(token, CANCEL_DEADLINE);
+	}
+
+	if (token->client_fd != -1) {
+		pfd.fd      = token->client_fd;
+		pfd.events  = POLLRDHUP;
+		pfd.revents = 0;
+		if (poll(&pfd, 1, 0) > 0 &&
+				(pfd.revents & (POLLRDHUP | POLLHUP | POLLERR)))
+			cancel_token_trip(token, CANCEL_DISCONNECT);
+	}
+
+	return cancel_token_reason(token);
+}
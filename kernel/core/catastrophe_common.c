@@ -2,22 +2,35 @@
 #include <kernel/core/equation.h>
 #include <kernel/core/cmplx_equation.h>
 #include <kernel/cache/simple.h>
+#include <kernel/cache/file.h>
 #include <kernel/core/config.h>
+#include <kernel/integration/dormand_prince.h>
+#include <kernel/integration/cmplx_dormand_prince.h>
+#include <kernel/integration/runge_kutta_batch.h>
+#include <kernel/integration/cmplx_runge_kutta_batch.h>
+#include <kernel/integration/runge_kutta_fixed.h>
+#include <kernel/integration/magnus.h>
+#include <kernel/integration/cmplx_magnus.h>
+#include <kernel/integration/bulirsch_stoer.h>
+#include <kernel/integration/cmplx_bulirsch_stoer.h>
+#include <kernel/integration/kutta_merson.h>
+#include <kernel/integration/cmplx_kutta_merson.h>
 #include <string.h>
+#include <stdlib.h>
+#include <limits.h>
 #include <assert.h>
 #include <pthread.h>
+#include <math.h>
 
 static DECLARE_LIST_HEAD(catastrophe_desc_list);
 
 void register_catastrophe_desc(catastrophe_desc_t *cd)
 {
-	unsigned int i;
 #ifdef CONFIG_CACHE_RESULT
 #ifdef CONFIG_PARALLEL_COMP
 	pthread_spin_init(&cd->cache_root_lock, PTHREAD_PROCESS_PRIVATE);
 #endif
-	for (i = 0; i < cd->num_equations; i++)
-		cd->cache_root[i] = NULL;
+	cd->cache = NULL;
 #endif
 	list_add_tail(&cd->list, &catastrophe_desc_list);
 }
@@ -94,126 +107,1141 @@ void save_computing_result(catastrophe_t *const catastrophe, unsigned int i,
 	point_array->array[i][j].phase  = phase;
 }
 
-int catastrophe_loop(catastrophe_t *const catastrophe)
+#ifdef CONFIG_CACHE_RESULT
+/*
+ * The results computed by a thread are kept in its front and added to the
+ * cache of the descriptor at once: at the end of the tile, or when the front
+ * is full. The lock of the cache is taken for the whole batch, the readers
+ * take no lock.
+ */
+struct catastrophe_cache_front {
+	catastrophe_desc_t   *descriptor;
+	struct catastrophe_cache *cache;
+	unsigned int          deriv;
+	unsigned int          num_results;
+	/* Bytes of the results packed one after another in the data */
+	size_t                used;
+	double                data[CONFIG_CACHE_BATCH * 8];
+};
+
+static __thread struct catastrophe_cache_front cache_front;
+
+static struct catastrophe_cache *catastrophe_cache_find(
+		catastrophe_desc_t *desc, catastrophe_sweep_t sweep,
+		catastrophe_method_t method, double tol)
 {
-	unsigned int i, j;
-	uint_pair_t pair;
+	struct catastrophe_cache *cache;
 
-	fprintf(stderr, "Catastrophe %s calculation.\n",
-			catastrophe->sym_name);
+	for (cache = __atomic_load_n(&desc->cache, __ATOMIC_ACQUIRE); cache;
+	     cache = cache->next)
+		if (cache->sweep == sweep && cache->method == method &&
+		    cache->tol == tol)
+			return cache;
 
-	pair = catastrophe_search_alterable_params(catastrophe);
-	if (!catastrophe_is_pair_correct(&pair)) {
-		WAVECAT_ERROR(-1);
-		return -1;
+	return NULL;
+}
+
+/*
+ * catastrophe_cache_class() - the cache of the results computed by the sweep
+ * with the method and the tolerance of the catastrophe, added if missing.
+ *
+ * A job asking for a tighter tolerance or another method never takes the
+ * points computed less accurately. Only the default tolerance and the ones
+ * of the qualities have their caches, so the clients cannot add the classes
+ * without bound. Returns NULL for any other tolerance, or if the cache
+ * cannot be allocated.
+ */
+static struct catastrophe_cache *catastrophe_cache_class(
+		catastrophe_t *const catastrophe, catastrophe_sweep_t sweep)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+	catastrophe_method_t method = catastrophe->method;
+	struct catastrophe_cache *cache;
+	double tol = catastrophe->tol;
+
+	/* The fixed step methods do not depend on the tolerance */
+	if (sweep == SWEEP_POINT &&
+	    (method == METHOD_RK4 || method == METHOD_MAGNUS))
+		tol = 0;
+
+	if (tol != 0 && tol != CONFIG_QUALITY_PREVIEW_TOL &&
+	    tol != CONFIG_QUALITY_NORMAL_TOL && tol != CONFIG_QUALITY_HIGH_TOL)
+		return NULL;
+
+	cache = catastrophe_cache_find(desc, sweep, method, tol);
+	if (cache)
+		return cache;
+
+#ifdef CONFIG_PARALLEL_COMP
+	pthread_spin_lock(&desc->cache_root_lock);
+#endif
+	/* Another thread may have added it */
+	cache = catastrophe_cache_find(desc, sweep, method, tol);
+	if (!cache) {
+		cache = calloc(1, sizeof(*cache));
+		if (cache) {
+			cache->sweep = sweep;
+			cache->method = method;
+			cache->tol = tol;
+			cache->next = desc->cache;
+			__atomic_store_n(&desc->cache, cache,
+					__ATOMIC_RELEASE);
+		}
+	}
+#ifdef CONFIG_PARALLEL_COMP
+	pthread_spin_unlock(&desc->cache_root_lock);
+#endif
+
+	if (!cache)
+		perror("[error] Cannot allocate cache");
+
+	return cache;
+}
+
+/*
+ * catastrophe_cache_file() - the section of the cache file with the results
+ * of the derivative, NULL if there is no such section or no file.
+ */
+static struct cache_file_section *catastrophe_cache_file(
+		catastrophe_desc_t *desc, struct catastrophe_cache *cache,
+		unsigned int deriv, int create)
+{
+	struct cache_file_section *section;
+
+	section = __atomic_load_n(&cache->file[deriv], __ATOMIC_RELAXED);
+	if (section)
+		return section;
+
+	section = cache_file_section(desc->sym_name, desc->type, deriv,
+			desc->num_parameters, desc->par_names, cache->sweep,
+			cache->method, cache->tol, create);
+	if (section)
+		__atomic_store_n(&cache->file[deriv], section,
+				__ATOMIC_RELAXED);
+
+	return section;
+}
+
+/*
+ * catastrophe_cache_flush() - add the results of the front of the thread to
+ * the cache and to the cache file.
+ */
+static void catastrophe_cache_flush(void)
+{
+	struct catastrophe_cache_front *front = &cache_front;
+	catastrophe_desc_t *desc = front->descriptor;
+	struct cache_file_section *section;
+	struct cached_result *result;
+	size_t pos;
+
+	if (!front->num_results)
+		return;
+
+#ifdef CONFIG_PARALLEL_COMP
+	pthread_spin_lock(&desc->cache_root_lock);
+#endif
+	for (pos = 0; pos < front->used;
+	     pos += cached_result_size(result->num_parameters)) {
+		result = (struct cached_result *) ((char *) front->data + pos);
+		simple_cache_save_result(&front->cache->root[front->deriv],
+				result);
+	}
+#ifdef CONFIG_PARALLEL_COMP
+	pthread_spin_unlock(&desc->cache_root_lock);
+#endif
+
+	section = catastrophe_cache_file(desc, front->cache, front->deriv, 1);
+	if (section) {
+		cache_file_lock();
+		for (pos = 0; pos < front->used;
+		     pos += cached_result_size(result->num_parameters)) {
+			result = (struct cached_result *)
+				((char *) front->data + pos);
+			cache_file_save(section, result);
+		}
+		cache_file_unlock();
+	}
+
+	front->num_results = 0;
+	front->used = 0;
+}
+
+/*
+ * catastrophe_cache_search() - look for the point (i, j) in the cache.
+ *
+ * The key must contain the values of all the parameters in the point.
+ * Returns 1 and fills the point in the array when the result is found.
+ */
+static int catastrophe_cache_search(catastrophe_t *const catastrophe,
+		struct cached_result *key, unsigned int i, unsigned int j)
+{
+	point_array_t *pa = catastrophe->point_array;
+	struct catastrophe_cache *cache = catastrophe->cache;
+	struct cache_file_section *section;
+	struct cached_result *result;
+
+	/* The results may be computed in the tiles of another size */
+	if (catastrophe->deterministic || !cache)
+		return 0;
+
+	result = simple_cache_search_result(&cache->root[catastrophe->deriv],
+			key);
+	if (result) {
+		pa->array[i][j].module = result->point.module;
+		pa->array[i][j].phase = result->point.phase;
+		return 1;
+	}
+
+	/* The results of the other processes and the former runs */
+	section = catastrophe_cache_file(catastrophe->descriptor, cache,
+			catastrophe->deriv, 0);
+	if (section && cache_file_search(section, key)) {
+		pa->array[i][j].module = key->point.module;
+		pa->array[i][j].phase = key->point.phase;
+		return 1;
+	}
+
+	return 0;
+}
+
+/*
+ * catastrophe_cache_save() - put the computed point (i, j) to the front of
+ * the thread.
+ */
+static void catastrophe_cache_save(catastrophe_t *const catastrophe,
+		struct cached_result *key, unsigned int i, unsigned int j)
+{
+	struct catastrophe_cache_front *front = &cache_front;
+	point_array_t *pa = catastrophe->point_array;
+	struct cached_result *result;
+	size_t size = cached_result_size(key->num_parameters);
+
+	if (!catastrophe->cache)
+		return;
+
+	if (front->num_results == CONFIG_CACHE_BATCH ||
+	    front->used + size > sizeof(front->data) ||
+	    front->cache != catastrophe->cache ||
+	    front->deriv != catastrophe->deriv)
+		catastrophe_cache_flush();
+
+	result = (struct cached_result *) ((char *) front->data + front->used);
+	memcpy(result, key, size);
+	result->point.module = pa->array[i][j].module;
+	result->point.phase = pa->array[i][j].phase;
+
+	front->descriptor = catastrophe->descriptor;
+	front->cache = catastrophe->cache;
+	front->deriv = catastrophe->deriv;
+	front->used += size;
+	front->num_results++;
+}
+#endif /* CONFIG_CACHE_RESULT */
+
+/*
+ * Check the result of calculation in the point. In the case of infinum value
+ * the calculations must be stopped, the other threads of the job as well.
+ */
+static inline int catastrophe_point_diverged(catastrophe_t *const catastrophe,
+		unsigned int i, unsigned int j)
+{
+	point_array_t *pa = catastrophe->point_array;
+
+	if (pa->array[i][j].module > 100 || pa->array[i][j].module < -100) {
+		catastrophe_cancel(catastrophe, CANCEL_FAILED);
+		return 1;
 	}
 
-	unsigned int p1_idx = pair.first;
-	unsigned int p2_idx = pair.second;
+	return 0;
+}
+
+static int catastrophe_loop_point(catastrophe_t *const catastrophe,
+		uint_pair_t *pair)
+{
+	unsigned int i, j;
+
+	unsigned int p1_idx = pair->first;
+	unsigned int p2_idx = pair->second;
 
 	double p1_min = catastrophe->parameter[p1_idx].min_value;
 	double p2_min = catastrophe->parameter[p2_idx].min_value;
-	double p1_max = catastrophe->parameter[p1_idx].max_value;
-	double p2_max = catastrophe->parameter[p2_idx].max_value;
 	double p1_steps = catastrophe->parameter[p1_idx].num_steps;
 	double p2_steps = catastrophe->parameter[p2_idx].num_steps;
 	double p1_step_size = catastrophe->parameter[p1_idx].step_size;
 	double p2_step_size = catastrophe->parameter[p2_idx].step_size;
 
-	point_array_t *pa = catastrophe->point_array;
-
 #ifdef CONFIG_CACHE_RESULT
-	struct cached_result  temp_key;
-	struct cached_result *result;
+	union cached_key      temp_storage;
+	struct cached_result *temp_key = &temp_storage.result;
 
-	temp_key.num_parameters = catastrophe->num_parameters;
+	temp_key->num_parameters = catastrophe->num_parameters;
 	for (i = 0; i < catastrophe->num_parameters; i++) {
-		temp_key.parameter[i] = catastrophe->parameter[i].cur_value;
+		temp_key->parameter[i] = catastrophe->parameter[i].cur_value;
 	}
 #endif
 
 	for (i = 0; i < p1_steps; i++) {
+		if (catastrophe_cancelled(catastrophe))
+			return -1;
+
 		/* Calculate the current value of the parameter */
 		catastrophe->parameter[p1_idx].cur_value =
 			p1_min + i * p1_step_size;
 #ifdef CONFIG_CACHE_RESULT
-		temp_key.parameter[p1_idx] =
+		temp_key->parameter[p1_idx] =
 			catastrophe->parameter[p1_idx].cur_value;
 #endif
 		for (j = 0; j < p2_steps; j++) {
 			catastrophe->parameter[p2_idx].cur_value =
 				p2_min + j * p2_step_size;
 #ifdef CONFIG_CACHE_RESULT
-			temp_key.parameter[p2_idx] =
+			temp_key->parameter[p2_idx] =
 				catastrophe->parameter[p2_idx].cur_value;
 
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_lock(
-				&catastrophe->descriptor->cache_root_lock);
-#endif
-			result = simple_cache_search_result(
-					&catastrophe->descriptor->cache_root[catastrophe->deriv],
-					&temp_key);
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_unlock(
-				&catastrophe->descriptor->cache_root_lock);
-#endif
-			if (result) {
-				pa->array[i][j].module =
-					result->point.module;
-				pa->array[i][j].phase =
-					result->point.phase;
+			if (catastrophe_cache_search(catastrophe, temp_key,
+						i, j))
 				continue;
-			}
 #endif
 			catastrophe->calculate(catastrophe, i, j);
+			/* A failed integration has cancelled the job */
+			if (catastrophe_cancel_reason(catastrophe))
+				return -1;
 			save_computing_result(catastrophe, i, j);
 
-			/*
-			 * Check the result of calculation in the point.
-			 * In the case of infinum value the calculations
-			 * must be stopped.
-			 */
-			if (pa->array[i][j].module > 100 ||
-				pa->array[i][j].module < -100) {
+			if (catastrophe_point_diverged(catastrophe, i, j)) {
 				WAVECAT_ERROR(-1);
 				return -1;
 			}
 
 #ifdef CONFIG_CACHE_RESULT
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_lock(
-				&catastrophe->descriptor->cache_root_lock);
+			catastrophe_cache_save(catastrophe, temp_key, i, j);
 #endif
-			result = simple_cache_cached_result_alloc();
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_unlock(
-				&catastrophe->descriptor->cache_root_lock);
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Integration vectors of a batch, the components of the points are
+ * interleaved so that the loops over the points are vectorized.
+ */
+union catastrophe_batch_vector {
+	double         real[CONFIG_CAT_MAX_EQUATIONS][CONFIG_BATCH_WIDTH];
+	double complex cmplx[CONFIG_CAT_MAX_EQUATIONS][CONFIG_BATCH_WIDTH];
+};
+
+static inline int catastrophe_has_batch(catastrophe_desc_t *desc)
+{
+	if (!desc->initial)
+		return 0;
+
+	switch (desc->type) {
+	case CT_REAL:
+		return desc->batch.real != NULL;
+	case CT_COMPLEX:
+		return desc->batch.cmplx != NULL;
+	}
+
+	return 0;
+}
+
+/*
+ * catastrophe_batch_load() - put the current point to the lane w of the batch.
+ */
+static void catastrophe_batch_load(catastrophe_t *const catastrophe,
+		double (*p)[CONFIG_BATCH_WIDTH],
+		union catastrophe_batch_vector *y, unsigned int w)
+{
+	unsigned int i;
+
+	for (i = 0; i < catastrophe->num_parameters; i++)
+		p[i][w] = catastrophe->parameter[i].cur_value;
+
+	catastrophe->descriptor->initial(catastrophe);
+
+	switch (catastrophe->descriptor->type) {
+	case CT_REAL: {
+		equation_t *equation = catastrophe->equation;
+
+		for (i = 0; i < equation->num_equations; i++)
+			y->real[i][w] = equation->initial_vector[i];
+		break;
+	}
+	case CT_COMPLEX: {
+		cmplx_equation_t *equation = catastrophe->equation;
+
+		for (i = 0; i < equation->num_equations; i++)
+			y->cmplx[i][w] = equation->initial_vector[i];
+		break;
+	}
+	}
+}
+
+/*
+ * catastrophe_batch_store() - put the lane w of the batch to the resulting
+ * vector.
+ */
+static void catastrophe_batch_store(catastrophe_t *const catastrophe,
+		union catastrophe_batch_vector *y, unsigned int w)
+{
+	unsigned int i;
+
+	switch (catastrophe->descriptor->type) {
+	case CT_REAL: {
+		equation_t *equation = catastrophe->equation;
+
+		for (i = 0; i < equation->num_equations; i++)
+			equation->resulting_vector[i] = y->real[i][w];
+		break;
+	}
+	case CT_COMPLEX: {
+		cmplx_equation_t *equation = catastrophe->equation;
+
+		for (i = 0; i < equation->num_equations; i++)
+			equation->resulting_vector[i] = y->cmplx[i][w];
+		break;
+	}
+	}
+}
+
+/*
+ * catastrophe_batch_integrate() - integrate the batch, only the first
+ * num_lanes lanes are points of the grid and counted as integrations.
+ */
+static void catastrophe_batch_integrate(catastrophe_t *const catastrophe,
+		double (*p)[CONFIG_BATCH_WIDTH],
+		union catastrophe_batch_vector *y, unsigned int num_lanes)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+	unsigned long steps = 0;
+
+	switch (desc->type) {
+	case CT_REAL:
+		steps = runge_kutta_batch(0.0, 1.0, desc->batch_step,
+				desc->batch.real,
+				((equation_t *) catastrophe->equation)->
+				num_equations,
+				(const double (*)[CONFIG_BATCH_WIDTH]) p,
+				y->real);
+		break;
+	case CT_COMPLEX:
+		steps = cmplx_runge_kutta_batch(0.0, 1.0, desc->batch_step,
+				desc->batch.cmplx,
+				((cmplx_equation_t *) catastrophe->equation)->
+				num_equations,
+				(const double (*)[CONFIG_BATCH_WIDTH]) p,
+				y->cmplx);
+		break;
+	}
+
+	INTEGRATION_STATS_ADD(&catastrophe->stats, num_lanes,
+			num_lanes * steps, 0, 4 * num_lanes * steps);
+}
+
+/*
+ * catastrophe_loop_batch() - compute the grid by CONFIG_BATCH_WIDTH points
+ * of a row at once with the batch function of the descriptor.
+ */
+static int catastrophe_loop_batch(catastrophe_t *const catastrophe,
+		uint_pair_t *pair)
+{
+	unsigned int i, j, w, num_lanes;
+	unsigned int lane_j[CONFIG_BATCH_WIDTH];
+
+	double p[CONFIG_CAT_MAX_PARAMETERS][CONFIG_BATCH_WIDTH]
+		__attribute__ ((aligned (64)));
+	union catastrophe_batch_vector y __attribute__ ((aligned (64)));
+
+	unsigned int p1_idx = pair->first;
+	unsigned int p2_idx = pair->second;
+
+	double p1_min = catastrophe->parameter[p1_idx].min_value;
+	double p2_min = catastrophe->parameter[p2_idx].min_value;
+	unsigned int p1_steps = catastrophe->parameter[p1_idx].num_steps;
+	unsigned int p2_steps = catastrophe->parameter[p2_idx].num_steps;
+	double p1_step_size = catastrophe->parameter[p1_idx].step_size;
+	double p2_step_size = catastrophe->parameter[p2_idx].step_size;
+
+#ifdef CONFIG_CACHE_RESULT
+	union cached_key      temp_storage;
+	struct cached_result *temp_key = &temp_storage.result;
+
+	temp_key->num_parameters = catastrophe->num_parameters;
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		temp_key->parameter[i] = catastrophe->parameter[i].cur_value;
+	}
+#endif
+
+	for (i = 0; i < p1_steps; i++) {
+		if (catastrophe_cancelled(catastrophe))
+			return -1;
+
+		catastrophe->parameter[p1_idx].cur_value =
+			p1_min + i * p1_step_size;
+#ifdef CONFIG_CACHE_RESULT
+		temp_key->parameter[p1_idx] =
+			catastrophe->parameter[p1_idx].cur_value;
 #endif
-			if (!result)
+		j = 0;
+		while (j < p2_steps) {
+			/* Gather the points of the row missing in the cache */
+			for (num_lanes = 0;
+			     num_lanes < CONFIG_BATCH_WIDTH && j < p2_steps;
+			     j++) {
+				catastrophe->parameter[p2_idx].cur_value =
+					p2_min + j * p2_step_size;
+#ifdef CONFIG_CACHE_RESULT
+				temp_key->parameter[p2_idx] =
+					catastrophe->parameter[p2_idx].cur_value;
+
+				if (catastrophe_cache_search(catastrophe,
+							temp_key, i, j))
+					continue;
+#endif
+				catastrophe_batch_load(catastrophe, p, &y,
+						num_lanes);
+				lane_j[num_lanes++] = j;
+			}
+
+			if (!num_lanes)
 				continue;
 
-			memcpy(result, &temp_key, sizeof(*result));
-			result->point.module = pa->array[i][j].module;
-			result->point.phase = pa->array[i][j].phase;
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_lock(
-				&catastrophe->descriptor->cache_root_lock);
+			/* The rest of the lanes repeat the last point */
+			for (w = num_lanes; w < CONFIG_BATCH_WIDTH; w++)
+				catastrophe_batch_load(catastrophe, p, &y, w);
+
+			catastrophe_batch_integrate(catastrophe, p, &y,
+					num_lanes);
+
+			for (w = 0; w < num_lanes; w++) {
+				catastrophe_batch_store(catastrophe, &y, w);
+				save_computing_result(catastrophe, i, lane_j[w]);
+
+				if (catastrophe_point_diverged(catastrophe, i,
+							lane_j[w])) {
+					WAVECAT_ERROR(-1);
+					return -1;
+				}
+
+#ifdef CONFIG_CACHE_RESULT
+				temp_key->parameter[p2_idx] =
+					p2_min + lane_j[w] * p2_step_size;
+				catastrophe_cache_save(catastrophe, temp_key,
+						i, lane_j[w]);
 #endif
-			simple_cache_save_result(
-					&catastrophe->descriptor->cache_root[catastrophe->deriv],
-					result);
-#ifdef CONFIG_PARALLEL_COMP
-			pthread_spin_unlock(
-				&catastrophe->descriptor->cache_root_lock);
+			}
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * Parameters entering the equations as lambda * t make the solution at t = s
+ * equal to the solution at t = 1 for the parameters scaled by s. So all the
+ * grid points lying on the same ray from the origin are obtained from one
+ * integration up to the farthest of them, if the other scaled parameters are
+ * zero (they would move along the ray too) and the initial vector does not
+ * depend on the scaled parameters.
+ */
+static int catastrophe_ray_is_possible(catastrophe_t *const catastrophe,
+		uint_pair_t *pair)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+	parameter_t *par;
+	double base;
+	unsigned int i;
+
+	if (!desc->initial)
+		return 0;
+
+	if (!(desc->ray_params & PARAM_MASK(pair->first)) ||
+			!(desc->ray_params & PARAM_MASK(pair->second)))
+		return 0;
+
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		if (i == pair->first || i == pair->second)
+			continue;
+		if ((desc->ray_params & PARAM_MASK(i)) &&
+				catastrophe->parameter[i].cur_value != 0.0)
+			return 0;
+	}
+
+	/* The origin must be a node of the grid */
+	par = &catastrophe->parameter[pair->first];
+	base = par->min_value / par->step_size;
+	if (fabs(base - round(base)) > 1e-6)
+		return 0;
+
+	par = &catastrophe->parameter[pair->second];
+	base = par->min_value / par->step_size;
+	if (fabs(base - round(base)) > 1e-6)
+		return 0;
+
+	return 1;
+}
+
+/*
+ * The continuation moves the varying parameters along a straight segment,
+ * both of them must enter the equations through PARAM_AT().
+ */
+static inline int catastrophe_continuation_is_possible(
+		catastrophe_t *const catastrophe, uint_pair_t *pair)
+{
+	unsigned long ray_params = catastrophe->descriptor->ray_params;
+
+	return ((ray_params & PARAM_MASK(pair->first)) &&
+		(ray_params & PARAM_MASK(pair->second)));
+}
+
+static unsigned int gcd(unsigned int a, unsigned int b)
+{
+	unsigned int r;
+
+	while (b) {
+		r = a % b;
+		a = b;
+		b = r;
+	}
+
+	return a;
+}
+
+/*
+ * catastrophe_integrate() - integrate the equations of the descriptor from
+ * the initial vector over t in [0, 1] saving the solutions at dense_t, the
+ * number of the first ones saved is returned in num_saved.
+ */
+static int catastrophe_integrate(catastrophe_t *const catastrophe,
+		const double step, const double *dense_t,
+		unsigned int num_dense, void *dense_vector,
+		unsigned int *num_saved)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+
+	switch (desc->type) {
+	case CT_REAL:
+		equation_set_function((equation_t *) catastrophe->equation,
+				desc->equation.real);
+		return dormand_prince_dense(0.0, 1.0, step,
+				catastrophe_abs_tol(catastrophe),
+				catastrophe_rel_tol(catastrophe),
+				catastrophe, NULL, dense_t, num_dense,
+				dense_vector, num_saved);
+	case CT_COMPLEX:
+		cmplx_equation_set_function(
+				(cmplx_equation_t *) catastrophe->equation,
+				desc->equation.cmplx);
+		return cmplx_dormand_prince_dense(0.0, 1.0, step,
+				catastrophe_abs_tol(catastrophe),
+				catastrophe_rel_tol(catastrophe),
+				catastrophe, NULL, dense_t, num_dense,
+				dense_vector, num_saved);
+	}
+
+	return -1;
+}
+
+static void catastrophe_set_result(catastrophe_t *const catastrophe,
+		void *dense_vector, unsigned int k)
+{
+	switch (catastrophe->descriptor->type) {
+	case CT_REAL: {
+		equation_t *equation = catastrophe->equation;
+		double (*vector)[CONFIG_CAT_MAX_EQUATIONS] = dense_vector;
+
+		memcpy(equation->resulting_vector, vector[k],
+				sizeof(vector[k]));
+		break;
+	}
+	case CT_COMPLEX: {
+		cmplx_equation_t *equation = catastrophe->equation;
+		double complex (*vector)[CONFIG_CAT_MAX_EQUATIONS] =
+			dense_vector;
+
+		memcpy(equation->resulting_vector, vector[k],
+				sizeof(vector[k]));
+		break;
+	}
+	}
+}
+
+/*
+ * catastrophe_calculate_at() - compute the point (i, j) of the grid with
+ * calculate(), returns -1 if the integration has failed.
+ */
+static int catastrophe_calculate_at(catastrophe_t *const catastrophe,
+		uint_pair_t *pair, unsigned int i, unsigned int j)
+{
+	parameter_t *p1 = &catastrophe->parameter[pair->first];
+	parameter_t *p2 = &catastrophe->parameter[pair->second];
+
+	p1->cur_value = p1->min_value + i * p1->step_size;
+	p2->cur_value = p2->min_value + j * p2->step_size;
+	catastrophe->calculate(catastrophe, i, j);
+
+	/* A failed integration has cancelled the job */
+	return catastrophe_cancel_reason(catastrophe) ? -1 : 0;
+}
+
+/*
+ * catastrophe_loop_ray() - compute the grid ray by ray.
+ *
+ * A grid point with integer coordinates (n1, n2) relative to the origin
+ * lies on the ray (n1, n2) / gcd(n1, n2). Only the farthest point of every
+ * ray inside the grid starts an integration, the nearer ones are filled
+ * from its dense output at t = k / gcd(n1, n2). The points past a failure of
+ * the integration are computed one by one.
+ */
+static int catastrophe_loop_ray(catastrophe_t *const catastrophe,
+		uint_pair_t *pair)
+{
+	unsigned int i, j, k, g, num_dense, max_dense, num_saved;
+	int n1, n2, d1, d2, base1, base2, i_k, j_k;
+	double *dense_t;
+	void *dense_vector;
+	int ret = 0;
+
+	unsigned int p1_idx = pair->first;
+	unsigned int p2_idx = pair->second;
+
+	double p1_min = catastrophe->parameter[p1_idx].min_value;
+	double p2_min = catastrophe->parameter[p2_idx].min_value;
+	int p1_steps = catastrophe->parameter[p1_idx].num_steps;
+	int p2_steps = catastrophe->parameter[p2_idx].num_steps;
+	double p1_step_size = catastrophe->parameter[p1_idx].step_size;
+	double p2_step_size = catastrophe->parameter[p2_idx].step_size;
+
+#ifdef CONFIG_CACHE_RESULT
+	union cached_key      temp_storage;
+	struct cached_result *temp_key = &temp_storage.result;
+	unsigned int num_cached;
+
+	temp_key->num_parameters = catastrophe->num_parameters;
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		temp_key->parameter[i] = catastrophe->parameter[i].cur_value;
+	}
+#endif
+
+	base1 = lround(p1_min / p1_step_size);
+	base2 = lround(p2_min / p2_step_size);
+
+	/* A ray crosses at most that number of the grid points */
+	max_dense = (p1_steps > p2_steps) ? p1_steps : p2_steps;
+
+	dense_t = malloc(sizeof(*dense_t) * max_dense);
+	dense_vector = malloc(sizeof(double complex) *
+			CONFIG_CAT_MAX_EQUATIONS * max_dense);
+	if (!dense_t || !dense_vector) {
+		ret = -1;
+		goto out;
+	}
+
+	for (i = 0; i < (unsigned int) p1_steps; i++) {
+		if (catastrophe_cancelled(catastrophe)) {
+			ret = -1;
+			goto out;
+		}
+
+		for (j = 0; j < (unsigned int) p2_steps; j++) {
+			n1 = base1 + (int) i;
+			n2 = base2 + (int) j;
+
+			/* The origin itself does not belong to any ray */
+			if (!n1 && !n2) {
+#ifdef CONFIG_CACHE_RESULT
+				temp_key->parameter[p1_idx] =
+					p1_min + i * p1_step_size;
+				temp_key->parameter[p2_idx] =
+					p2_min + j * p2_step_size;
+				if (catastrophe_cache_search(catastrophe,
+							temp_key, i, j))
+					continue;
+#endif
+				catastrophe->parameter[p1_idx].cur_value = 0.0;
+				catastrophe->parameter[p2_idx].cur_value = 0.0;
+				catastrophe->calculate(catastrophe, i, j);
+				if (catastrophe_cancel_reason(catastrophe)) {
+					ret = -1;
+					goto out;
+				}
+				save_computing_result(catastrophe, i, j);
+
+				if (catastrophe_point_diverged(catastrophe,
+							i, j)) {
+					WAVECAT_ERROR(-1);
+					ret = -1;
+					goto out;
+				}
+
+#ifdef CONFIG_CACHE_RESULT
+				catastrophe_cache_save(catastrophe, temp_key,
+						i, j);
+#endif
+				continue;
+			}
+
+			g = gcd(abs(n1), abs(n2));
+			d1 = n1 / (int) g;
+			d2 = n2 / (int) g;
+
+			/* Only the farthest point of the ray is processed */
+			if ((int) i + d1 >= 0 && (int) i + d1 < p1_steps &&
+			    (int) j + d2 >= 0 && (int) j + d2 < p2_steps)
+				continue;
+
+			/* The nearer points of the ray inside the grid */
+			for (k = g, num_dense = 0; k > 0; k--, num_dense++) {
+				i_k = (int) i - (int) (g - k) * d1;
+				j_k = (int) j - (int) (g - k) * d2;
+				if (i_k < 0 || i_k >= p1_steps ||
+				    j_k < 0 || j_k >= p2_steps)
+					break;
+			}
+
+#ifdef CONFIG_CACHE_RESULT
+			num_cached = 0;
+			for (k = 0; k < num_dense; k++) {
+				i_k = (int) i - (int) k * d1;
+				j_k = (int) j - (int) k * d2;
+				temp_key->parameter[p1_idx] =
+					p1_min + i_k * p1_step_size;
+				temp_key->parameter[p2_idx] =
+					p2_min + j_k * p2_step_size;
+				num_cached += catastrophe_cache_search(
+						catastrophe, temp_key,
+						i_k, j_k);
+			}
+			if (num_cached == num_dense)
+				continue;
+#endif
+
+			/* Ascending values of t, the farthest point is last */
+			for (k = 0; k < num_dense; k++)
+				dense_t[k] = (double) (g - num_dense + 1 + k) /
+					g;
+
+			catastrophe->parameter[p1_idx].cur_value =
+				p1_min + i * p1_step_size;
+			catastrophe->parameter[p2_idx].cur_value =
+				p2_min + j * p2_step_size;
+
+			catastrophe->descriptor->initial(catastrophe);
+			if (catastrophe_integrate(catastrophe,
+						CONFIG_RAY_INITIAL_STEP, dense_t,
+						num_dense, dense_vector,
+						&num_saved))
+				WAVECAT_ERROR(-1);
+
+			for (k = 0; k < num_dense; k++) {
+				i_k = (int) i - (int) (num_dense - 1 - k) * d1;
+				j_k = (int) j - (int) (num_dense - 1 - k) * d2;
+
+				if (k < num_saved) {
+					catastrophe_set_result(catastrophe,
+							dense_vector, k);
+				} else if (catastrophe_calculate_at(catastrophe,
+							pair, i_k, j_k)) {
+					ret = -1;
+					goto out;
+				}
+				save_computing_result(catastrophe, i_k, j_k);
+
+				if (catastrophe_point_diverged(catastrophe,
+							i_k, j_k)) {
+					WAVECAT_ERROR(-1);
+					ret = -1;
+					goto out;
+				}
+
+#ifdef CONFIG_CACHE_RESULT
+				temp_key->parameter[p1_idx] =
+					p1_min + i_k * p1_step_size;
+				temp_key->parameter[p2_idx] =
+					p2_min + j_k * p2_step_size;
+				catastrophe_cache_save(catastrophe, temp_key,
+						i_k, j_k);
+#endif
+			}
+		}
+	}
+
+out:
+	free(dense_t);
+	free(dense_vector);
+	return ret;
+}
+
+/*
+ * catastrophe_integrate_segment() - continue the solution of the previous
+ * point to the current one.
+ *
+ * The resulting vector holds the solution at the point (prev1, prev2) of the
+ * varying parameters. The parameters with bits in ray_params are replaced by
+ * the origin and the direction of the straight segment to the current point,
+ * the other ones keep their values.
+ */
+static int catastrophe_integrate_segment(catastrophe_t *const catastrophe,
+		uint_pair_t *pair, const double prev1, const double prev2)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+	double target[CONFIG_CAT_MAX_PARAMETERS];
+	unsigned int i;
+	int ret;
+
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		if (!(desc->ray_params & PARAM_MASK(i)))
+			continue;
+
+		target[i] = catastrophe->parameter[i].cur_value;
+		if (i == pair->first)
+			catastrophe->origin[i] = prev1;
+		else if (i == pair->second)
+			catastrophe->origin[i] = prev2;
+		else
+			catastrophe->origin[i] = target[i];
+		catastrophe->parameter[i].cur_value =
+			target[i] - catastrophe->origin[i];
+	}
+
+	switch (desc->type) {
+	case CT_REAL: {
+		equation_t *equation = catastrophe->equation;
+
+		memcpy(equation->initial_vector, equation->resulting_vector,
+				sizeof(equation->initial_vector));
+		break;
+	}
+	case CT_COMPLEX: {
+		cmplx_equation_t *equation = catastrophe->equation;
+
+		memcpy(equation->initial_vector, equation->resulting_vector,
+				sizeof(equation->initial_vector));
+		break;
+	}
+	}
+
+	ret = catastrophe_integrate(catastrophe,
+			CONFIG_CONTINUATION_INITIAL_STEP, NULL, 0, NULL, NULL);
+
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		if (!(desc->ray_params & PARAM_MASK(i)))
+			continue;
+
+		catastrophe->parameter[i].cur_value = target[i];
+		catastrophe->origin[i] = 0.0;
+	}
+
+	return ret;
+}
+
+/*
+ * catastrophe_anchor() - compute the point from the origin.
+ *
+ * The anchor points are integrated with the same method as the segments when
+ * the descriptor provides the initial vector, the error of the path is not
+ * mixed with the error of the fixed step method of calculate() then.
+ */
+static int catastrophe_anchor(catastrophe_t *const catastrophe,
+		unsigned int i, unsigned int j)
+{
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+
+	if (!desc->initial) {
+		catastrophe->calculate(catastrophe, i, j);
+		return catastrophe_cancel_reason(catastrophe) ? -1 : 0;
+	}
+
+	desc->initial(catastrophe);
+	return catastrophe_integrate(catastrophe, CONFIG_RAY_INITIAL_STEP,
+			NULL, 0, NULL, NULL);
+}
+
+/*
+ * catastrophe_loop_continuation() - compute the grid along a serpentine path.
+ *
+ * Every point but the anchor ones is integrated from the solution of the
+ * previous point of the path. The anchor points are computed from the origin
+ * every CONFIG_CONTINUATION_ANCHOR points to bound the error accumulated along
+ * the path, after a point taken from the cache, and in place of a failed
+ * segment. The tile fails if the anchor point fails too.
+ */
+static int catastrophe_loop_continuation(catastrophe_t *const catastrophe,
+		uint_pair_t *pair)
+{
+	unsigned int i, j, n, since_anchor = 0;
+	double prev1 = 0.0, prev2 = 0.0;
+	int has_state = 0;
+
+	unsigned int p1_idx = pair->first;
+	unsigned int p2_idx = pair->second;
+
+	double p1_min = catastrophe->parameter[p1_idx].min_value;
+	double p2_min = catastrophe->parameter[p2_idx].min_value;
+	unsigned int p1_steps = catastrophe->parameter[p1_idx].num_steps;
+	unsigned int p2_steps = catastrophe->parameter[p2_idx].num_steps;
+	double p1_step_size = catastrophe->parameter[p1_idx].step_size;
+	double p2_step_size = catastrophe->parameter[p2_idx].step_size;
+
+#ifdef CONFIG_CACHE_RESULT
+	union cached_key      temp_storage;
+	struct cached_result *temp_key = &temp_storage.result;
+
+	temp_key->num_parameters = catastrophe->num_parameters;
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		temp_key->parameter[i] = catastrophe->parameter[i].cur_value;
+	}
+#endif
+
+	for (i = 0; i < p1_steps; i++) {
+		if (catastrophe_cancelled(catastrophe))
+			return -1;
+
+		catastrophe->parameter[p1_idx].cur_value =
+			p1_min + i * p1_step_size;
+#ifdef CONFIG_CACHE_RESULT
+		temp_key->parameter[p1_idx] =
+			catastrophe->parameter[p1_idx].cur_value;
+#endif
+		for (n = 0; n < p2_steps; n++) {
+			/* Odd rows are passed backwards */
+			j = (i % 2) ? p2_steps - 1 - n : n;
+
+			catastrophe->parameter[p2_idx].cur_value =
+				p2_min + j * p2_step_size;
+#ifdef CONFIG_CACHE_RESULT
+			temp_key->parameter[p2_idx] =
+				catastrophe->parameter[p2_idx].cur_value;
+
+			if (catastrophe_cache_search(catastrophe, temp_key,
+						i, j)) {
+				has_state = 0;
+				continue;
+			}
+#endif
+			/* A failed segment is replaced by the anchor point */
+			if (!has_state ||
+			    since_anchor >= CONFIG_CONTINUATION_ANCHOR ||
+			    catastrophe_integrate_segment(catastrophe, pair,
+						prev1, prev2)) {
+				if (catastrophe_anchor(catastrophe, i, j)) {
+					WAVECAT_ERROR(-1);
+					return -1;
+				}
+				since_anchor = 0;
+			}
+
+			has_state = 1;
+			since_anchor++;
+			prev1 = catastrophe->parameter[p1_idx].cur_value;
+			prev2 = catastrophe->parameter[p2_idx].cur_value;
+
+			save_computing_result(catastrophe, i, j);
+
+			if (catastrophe_point_diverged(catastrophe, i, j)) {
+				WAVECAT_ERROR(-1);
+				return -1;
+			}
+
+#ifdef CONFIG_CACHE_RESULT
+			catastrophe_cache_save(catastrophe, temp_key, i, j);
 #endif
-#endif /* CONFIG_CACHE_RESULT */
 		}
 	}
 
 	return 0;
 }
 
+static int catastrophe_loop_sweep(catastrophe_t *const catastrophe,
+		uint_pair_t pair)
+{
+	catastrophe_sweep_t sweep = catastrophe->sweep;
+
+	if (sweep == SWEEP_RAY &&
+	    !catastrophe_ray_is_possible(catastrophe, &pair)) {
+		fprintf(stderr, "Ray sweep is impossible for the grid, "
+				"points are computed one by one.\n");
+		sweep = SWEEP_POINT;
+	}
+
+	if (sweep == SWEEP_CONTINUATION &&
+	    !catastrophe_continuation_is_possible(catastrophe, &pair)) {
+		fprintf(stderr, "Continuation is impossible for the "
+				"catastrophe, points are computed one by "
+				"one.\n");
+		sweep = SWEEP_POINT;
+	}
+
+#ifdef CONFIG_CACHE_RESULT
+	catastrophe->cache = catastrophe_cache_class(catastrophe, sweep);
+#endif
+
+	if (sweep == SWEEP_RAY)
+		return catastrophe_loop_ray(catastrophe, &pair);
+	if (sweep == SWEEP_CONTINUATION)
+		return catastrophe_loop_continuation(catastrophe, &pair);
+
+	/* The batch kernels implement the Runge-Kutta method only */
+	if (catastrophe->method == METHOD_RK4 &&
+	    catastrophe_has_batch(catastrophe->descriptor))
+		return catastrophe_loop_batch(catastrophe, &pair);
+
+	return catastrophe_loop_point(catastrophe, &pair);
+}
+
+int catastrophe_loop(catastrophe_t *const catastrophe)
+{
+	uint_pair_t pair;
+	int ret;
+
+	pair = catastrophe_search_alterable_params(catastrophe);
+	if (!catastrophe_is_pair_correct(&pair)) {
+		WAVECAT_ERROR(-1);
+		return -1;
+	}
+
+	ret = catastrophe_loop_sweep(catastrophe, pair);
+
+#ifdef CONFIG_CACHE_RESULT
+	/* The results of the tile are published in a batch */
+	catastrophe_cache_flush();
+#endif
+
+	return ret;
+}
+
+/**
+ * catastrophe_account_stats() - log the work of the integrators for the job
+ * @catastrophe pointer to a catastrophe with the counters of all the threads
+ *
+ * The counters are added to the ones of the descriptor, both are printed.
+ */
+void catastrophe_account_stats(catastrophe_t *const catastrophe)
+{
+#ifdef CONFIG_INTEGRATION_STATS
+	catastrophe_desc_t *desc = catastrophe->descriptor;
+	integration_stats_t *stats = &catastrophe->stats;
+	unsigned long points;
+
+	points = catastrophe->point_array->num_steps_x *
+		catastrophe->point_array->num_steps_y;
+
+	integration_stats_merge(&desc->stats, stats);
+
+	fprintf(stderr, "[stats] %s: %lu integrations (%.2f per point), "
+			"%lu steps, %lu rejected, %lu evaluations\n",
+			catastrophe->sym_name, stats->integrations,
+			points ? (double) stats->integrations / points : 0.0,
+			stats->accepted, stats->rejected, stats->evaluations);
+	fprintf(stderr, "[stats] %s total: %lu integrations, %lu steps, "
+			"%lu rejected, %lu evaluations\n",
+			desc->sym_name, desc->stats.integrations,
+			desc->stats.accepted, desc->stats.rejected,
+			desc->stats.evaluations);
+#endif
+}
+
 static int bind_parameter_names(catastrophe_desc_t *desc,
 		catastrophe_t *cat, parameter_t *par)
 {
@@ -240,6 +1268,166 @@ static int bind_parameter_names(catastrophe_desc_t *desc,
 	return 0;
 }
 
+/*
+ * The stepper of the descriptor has the function inlined, the other systems
+ * get the method specialized for their size if any.
+ */
+static catastrophe_integrate_t catastrophe_select_integrate(
+		catastrophe_desc_t *desc, catastrophe_method_t method)
+{
+	switch (method) {
+	case METHOD_MAGNUS:
+		if (!desc->linear ||
+		    desc->num_equations > CONFIG_MAGNUS_MAX_EQUATIONS)
+			return NULL;
+		return (desc->type == CT_REAL) ? magnus : cmplx_magnus;
+	case METHOD_GBS:
+		return (desc->type == CT_REAL) ?
+			bulirsch_stoer : cmplx_bulirsch_stoer;
+	case METHOD_KUTTA_MERSON:
+		return (desc->type == CT_REAL) ?
+			kutta_merson : cmplx_kutta_merson;
+	case METHOD_DEFAULT:
+	case METHOD_RK4:
+		break;
+	}
+
+	if (desc->stepper)
+		return desc->stepper;
+
+	switch (desc->type) {
+	case CT_REAL:
+		return runge_kutta_fixed(desc->num_equations);
+	case CT_COMPLEX:
+		return cmplx_runge_kutta_fixed(desc->num_equations);
+	}
+
+	return NULL;
+}
+
+/**
+ * catastrophe_snap_lattice() - move the axis of a grid onto the dyadic
+ * lattice
+ * @parameter the parameter varied along the axis
+ * @level     returns the level of the lattice, its step is 2^-level
+ *
+ * The step is the largest power of two not above the requested one, the
+ * ends are moved outwards to its multiples and the number of the steps is
+ * recounted, no more than twice the requested one and two more. The points
+ * of the grid are then exact multiples of the step, so the overlapping grids
+ * of a level and the grids of the neighbouring levels share the keys of the
+ * cache, and the requested range is still covered.
+ *
+ * Returns 0 on success and -1 if the values are too large for the step.
+ */
+int catastrophe_snap_lattice(parameter_t *parameter, int *level)
+{
+	double step, lo, hi, max_steps;
+	int reversed;
+
+	if (!parameter->num_steps ||
+	    parameter->min_value == parameter->max_value)
+		return -1;
+
+	reversed = parameter->max_value < parameter->min_value;
+	max_steps = fmin(2.0 * parameter->num_steps + 2, UINT_MAX);
+
+	step = fabs(parameter->max_value - parameter->min_value) /
+		parameter->num_steps;
+	*level = (int) ceil(-log2(step));
+
+	/* A coarser level is taken if the ends have grown too far apart */
+	for (;; (*level)--) {
+		step = ldexp(1.0, -*level);
+		lo = floor(fmin(parameter->min_value,
+					parameter->max_value) / step);
+		hi = ceil(fmax(parameter->min_value,
+					parameter->max_value) / step);
+
+		/* The multiples of the step are exact below 2^53 of them */
+		if (!isfinite(lo) || !isfinite(hi) ||
+		    fmax(fabs(lo), fabs(hi)) >= 9007199254740992.0)
+			return -1;
+
+		if (hi - lo <= max_steps)
+			break;
+	}
+
+	parameter->min_value = (reversed ? hi : lo) * step;
+	parameter->max_value = (reversed ? lo : hi) * step;
+	parameter->num_steps = (unsigned int) (hi - lo);
+
+	return 0;
+}
+
+/**
+ * catastrophe_set_method() - choose the method integrating the system
+ * @catastrophe pointer to a catastrophe
+ * @method      the method, METHOD_DEFAULT for the one of the descriptor
+ *
+ * Without the method of the descriptor the default one is RK4, or GBS if the
+ * job has requested the tolerance: it reaches the tolerance with the least
+ * evaluations of the function among the adaptive methods.
+ *
+ * Returns 0 on success and -1 if the method is not applicable to the system
+ * of the catastrophe, the previous method is kept then.
+ */
+int catastrophe_set_method(catastrophe_t *const catastrophe,
+		catastrophe_method_t method)
+{
+	catastrophe_integrate_t integrate;
+
+	if (method == METHOD_DEFAULT)
+		method = catastrophe->descriptor->method;
+	if (method == METHOD_DEFAULT && catastrophe->tol > 0)
+		method = METHOD_GBS;
+	if (method == METHOD_DEFAULT)
+		method = METHOD_RK4;
+
+	integrate = catastrophe_select_integrate(catastrophe->descriptor,
+			method);
+	if (!integrate)
+		return -1;
+
+	catastrophe->method = method;
+	catastrophe_set_integrate(catastrophe, integrate);
+
+	return 0;
+}
+
+/**
+ * catastrophe_construct_equation() - construct the equation of a descriptor
+ * @desc pointer to a catastrophe descriptor
+ *
+ * Returns a pointer to a new equation_t or cmplx_equation_t object depending
+ * on the type of the descriptor, NULL otherwise.
+ */
+void *catastrophe_construct_equation(catastrophe_desc_t *desc)
+{
+	switch (desc->type) {
+	case CT_REAL: {
+		equation_t *tequation;
+		tequation = construct_equation();
+		if (!tequation)
+			return NULL;
+		equation_set_function(tequation, desc->equation.real);
+		tequation->num_equations = desc->num_equations;
+		return tequation;
+	}
+	case CT_COMPLEX: {
+		cmplx_equation_t *tequation;
+		tequation = construct_cmplx_equation();
+		if (!tequation)
+			return NULL;
+		equation_set_function(tequation, desc->equation.cmplx);
+		tequation->num_equations = desc->num_equations;
+		return tequation;
+	}
+	}
+
+	return NULL;
+}
+
 catastrophe_t *catastrophe_fabric(catastrophe_desc_t *desc,
 		parameter_t *parameter, unsigned int deriv)
 {
@@ -258,6 +1446,9 @@ catastrophe_t *catastrophe_fabric(catastrophe_desc_t *desc,
 	catastrophe->descriptor = desc;
 	catastrophe->deriv      = deriv;
 
+	if (catastrophe_set_method(catastrophe, METHOD_DEFAULT))
+		goto error_bind_params;
+
 	if (desc->par_names) {
 		if (bind_parameter_names(desc, catastrophe, parameter))
 			goto error_bind_params;
@@ -267,32 +1458,10 @@ catastrophe_t *catastrophe_fabric(catastrophe_desc_t *desc,
 		catastrophe->num_parameters = desc->num_parameters;
 	}
 
-	switch (desc->type) {
-	case CT_REAL: {
-		equation_t *tequation;
-		tequation = construct_equation();
-		if (!tequation)
-			goto error_construct_equation;
-		equation_set_function(tequation, desc->equation.real);
-		tequation->num_equations = desc->num_equations;
-		catastrophe_set_equation(catastrophe, tequation);
-		equation = tequation;
-		break;
-	}
-	case CT_COMPLEX: {
-		cmplx_equation_t *tequation;
-		tequation = construct_cmplx_equation();
-		if (!tequation)
-			goto error_construct_equation;
-		equation_set_function(tequation, desc->equation.cmplx);
-		tequation->num_equations = desc->num_equations;
-		catastrophe_set_equation(catastrophe, tequation);
-		equation = tequation;
-		break;
-	}
-	default:
-		equation = NULL;
-	}
+	equation = catastrophe_construct_equation(desc);
+	if (!equation)
+		goto error_construct_equation;
+	catastrophe_set_equation(catastrophe, equation);
 
 	pair = catastrophe_search_alterable_params(catastrophe);
 	if (!catastrophe_is_pair_correct(&pair))
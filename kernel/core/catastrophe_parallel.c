@@ -1,24 +1,180 @@
 #include <kernel/core/catastrophe.h>
 #include <kernel/core/catastrophe_parallel.h>
+#include <kernel/core/thread_pool.h>
+#include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/cache/simple.h>
 #include <string.h>
+#include <stdlib.h>
 #include <pthread.h>
 #include <stdio.h>
 #include <errno.h>
 
-#define MAX_THREADS 8
-
 catastrophe_parallel_func_t catastrophe_parallel_loop;
 
-static void *parallel_loop_thread(void *param)
+/*
+ * The threads write the points straight into the grid of the job, each tile
+ * through a view of its rectangle. A thread keeps a copy of the job
+ * catastrophe with an own equation, the scratch of the integrators.
+ *
+ * The copy is allocated by the thread on its first tile, and the points of
+ * the grid are first written by the threads computing them, so both stay on
+ * the NUMA node of the thread when the pool is pinned.
+ */
+struct parallel_job {
+	catastrophe_t      *master;
+	catastrophe_t     **workers;
+	uint_pair_t         pair;
+};
+
+/* A tile of the grid computed by a thread of the pool */
+struct parallel_tile {
+	struct parallel_job *job;
+	unsigned int        first_x;
+	unsigned int        num_x;
+	unsigned int        first_y;
+	unsigned int        num_y;
+};
+
+/* A sub-integration of a point computed by a thread of the pool */
+struct parallel_sub {
+	catastrophe_t       cat;
+	double              step;
+};
+
+static void parallel_tile_params(parameter_t *parameter, unsigned int first,
+		unsigned int num)
+{
+	parameter->min_value += first * parameter->step_size;
+	parameter->max_value  = parameter->min_value +
+		num * parameter->step_size;
+	parameter->num_steps  = num;
+}
+
+static catastrophe_t *parallel_worker_create(catastrophe_t *master)
+{
+	catastrophe_t *cat;
+
+	cat = construct_catastrophe();
+	if (!cat)
+		return NULL;
+
+	*cat = *master;
+	cat->point_array = NULL;
+	memset(&cat->stats, 0, sizeof(cat->stats));
+
+	cat->equation = catastrophe_construct_equation(master->descriptor);
+	if (!cat->equation) {
+		free(cat);
+		return NULL;
+	}
+
+	return cat;
+}
+
+static long parallel_loop_item(void *param)
 {
+	struct parallel_tile *tile = param;
+	struct parallel_job *job = tile->job;
+	catastrophe_t *master = job->master;
+	catastrophe_t **worker = &job->workers[thread_pool_self()];
+	catastrophe_t *cat;
+	point_array_t view;
+	point_t *rows[CONFIG_TILE_SIZE];
 	long res;
-	catastrophe_t *cat = param;
 
-	fprintf(stderr, "[parallel] Computational thread started.\n");
+	/* The rest of the tiles are skipped once the job is cancelled */
+	if (catastrophe_cancelled(master))
+		return -1;
+
+	if (!*worker) {
+		*worker = parallel_worker_create(master);
+		if (!*worker) {
+			WAVECAT_ERROR(-ENOMEM);
+			catastrophe_cancel(master, CANCEL_FAILED);
+			return -1;
+		}
+	}
+	cat = *worker;
+
+	memcpy(cat->parameter, master->parameter, sizeof(cat->parameter));
+	parallel_tile_params(&cat->parameter[job->pair.first], tile->first_x,
+			tile->num_x);
+	parallel_tile_params(&cat->parameter[job->pair.second],
+			tile->first_y, tile->num_y);
+
+	point_array_view(&view, rows, master->point_array, tile->first_x,
+			tile->num_x, tile->first_y, tile->num_y);
+	cat->point_array = &view;
+
 	res = catastrophe_loop(cat);
-	fprintf(stderr, "[parallel] Computation finished.\n");
+	if (res)
+		catastrophe_cancel(cat, CANCEL_FAILED);
+
+	cat->point_array = NULL;
+
+	return res;
+}
+
+static long parallel_sub_item(void *param)
+{
+	struct parallel_sub *sub = param;
+
+	cmplx_runge_kutta(0.0, 1.0, sub->step, &sub->cat);
+
+	return 0;
+}
+
+/**
+ * cmplx_catastrophe_integrate_subs() - integrate the systems independent of
+ * each other from 0 to 1
+ * @catastrophe pointer to the catastrophe of the point
+ * @subs        the systems with their functions and initial vectors set
+ * @num_subs    number of the systems
+ * @step        step of the integration
+ *
+ * The results are left in the resulting vectors of the systems. They are
+ * integrated one after another unless the loop lets the point run them on
+ * the threads of the pool, see catastrophe_loop_smp(). The results are the
+ * same either way.
+ */
+void cmplx_catastrophe_integrate_subs(catastrophe_t *const catastrophe,
+		cmplx_equation_t *subs, unsigned int num_subs,
+		const double step)
+{
+	void *equation = catastrophe->equation;
+	unsigned int k;
+
+#ifdef CONFIG_PARALLEL_COMP
+	if (catastrophe->parallel_subs && num_subs > 1 &&
+	    num_subs <= CONFIG_CAT_MAX_SUBS) {
+		struct parallel_sub sub[CONFIG_CAT_MAX_SUBS];
+		void *args[CONFIG_CAT_MAX_SUBS];
+		long results[CONFIG_CAT_MAX_SUBS];
+
+		for (k = 0; k < num_subs; k++) {
+			sub[k].cat = *catastrophe;
+			sub[k].cat.equation = &subs[k];
+			memset(&sub[k].cat.stats, 0, sizeof(sub[k].cat.stats));
+			sub[k].step = step;
+			args[k] = &sub[k];
+		}
+
+		if (!thread_pool_run(parallel_sub_item, args, results,
+					num_subs, catastrophe->num_threads)) {
+			for (k = 0; k < num_subs; k++)
+				integration_stats_merge(&catastrophe->stats,
+						&sub[k].cat.stats);
+			return;
+		}
+	}
+#endif
+
+	for (k = 0; k < num_subs; k++) {
+		catastrophe->equation = &subs[k];
+		cmplx_runge_kutta(0.0, 1.0, step, catastrophe);
+	}
 
-	return (void *) res;
+	catastrophe->equation = equation;
 }
 
 void catastrophe_prepare_params(catastrophe_t *catastrophe,
@@ -46,6 +202,7 @@ void catastrophe_prepare_params(catastrophe_t *catastrophe,
 int catastrophe_loop_seq(catastrophe_t *catastrophe)
 {
 	uint_pair_t pair;
+	int ret;
 
 	pair = catastrophe_search_alterable_params(catastrophe);
 	if (!catastrophe_is_pair_correct(&pair)) {
@@ -55,102 +212,203 @@ int catastrophe_loop_seq(catastrophe_t *catastrophe)
 
 	catastrophe_prepare_params(catastrophe, pair.first, pair.second, 1);
 
-	return catastrophe_loop(catastrophe);
+	fprintf(stderr, "Catastrophe %s calculation.\n",
+			catastrophe->sym_name);
+
+	ret = catastrophe_loop(catastrophe);
+
+#ifdef CONFIG_CACHE_RESULT
+	simple_cache_reclaim();
+#endif
+
+	return ret;
 }
 
-int catastrophe_loop_smp(catastrophe_t *catastrophe)
+/*
+ * parallel_tile_size() - choose the sides of the tiles for a grid.
+ *
+ * The tiles start as squares of CONFIG_TILE_SIZE points a side. While the
+ * grid gives fewer than CONFIG_TILES_PER_THREAD tiles a thread, the longer
+ * side of a tile within the grid is halved, so a grid long along one axis
+ * is cut across it and a small one into the single points at worst.
+ */
+static void parallel_tile_size(unsigned int num_x, unsigned int num_y,
+		unsigned int num_workers, unsigned int *tile_x,
+		unsigned int *tile_y)
 {
-	int res, is_failed = 0;
-	unsigned int p1_idx, cores, thread_idx, first_idx, steps_per_core;
-	double p1_min, p1_max, p1_diff, p1_step;
+	unsigned int size_x = CONFIG_TILE_SIZE, size_y = CONFIG_TILE_SIZE;
+	unsigned int ext_x, ext_y;
+
+	while (((num_x + size_x - 1) / size_x) *
+	       ((num_y + size_y - 1) / size_y) <
+	       CONFIG_TILES_PER_THREAD * num_workers) {
+		ext_x = size_x < num_x ? size_x : num_x;
+		ext_y = size_y < num_y ? size_y : num_y;
+
+		if (ext_x >= ext_y && ext_x > 1)
+			size_x = (ext_x + 1) / 2;
+		else if (ext_y > 1)
+			size_y = (ext_y + 1) / 2;
+		else
+			break;
+	}
 
-	catastrophe_desc_t *catastrophe_desc;
-	catastrophe_t *new_cat;
-	uint_pair_t pair;
+	*tile_x = size_x < num_x ? size_x : num_x;
+	*tile_y = size_y < num_y ? size_y : num_y;
+}
 
-	catastrophe_t *tcatastrophe[MAX_THREADS + 1];
-	pthread_t      thread[MAX_THREADS + 1];
+/*
+ * parallel_subs_faster() - nonzero if the points of the grid are better
+ * computed one at a time, each with its sub-integrations run on the threads.
+ *
+ * Every integration of a point is taken as a unit of time. The tiles take
+ * the time of the points of the busiest thread, a point at a time takes the
+ * time of its sub-integrations spread over the threads and of the last one.
+ * Only the grids of a few points gain from that.
+ */
+static int parallel_subs_faster(catastrophe_t *catastrophe,
+		unsigned int num_points, unsigned int num_workers)
+{
+	unsigned int num_subs = catastrophe->descriptor->num_subs;
+	unsigned long tiles_time, subs_time;
 
-	cores = 4; /* TODO: get real number of cores */
+	if (num_subs < 2 || num_subs > CONFIG_CAT_MAX_SUBS)
+		return 0;
 
-	pair = catastrophe_search_alterable_params(catastrophe);
-	if (!catastrophe_is_pair_correct(&pair)) {
-		WAVECAT_ERROR(-1);
-		return -1;
-	}
+	tiles_time = (unsigned long) (num_points + num_workers - 1) /
+		num_workers * (num_subs + 1);
+	subs_time = (unsigned long) num_points *
+		((num_subs + num_workers - 1) / num_workers + 1);
 
-	catastrophe_prepare_params(catastrophe, pair.first, pair.second, cores);
+	return subs_time < tiles_time;
+}
 
-	p1_min   = catastrophe->parameter[pair.first].min_value;
-	p1_max   = catastrophe->parameter[pair.first].max_value;
-	p1_step  = catastrophe->parameter[pair.first].step_size;
+/*
+ * The grid is cut into the tiles of parallel_tile_size(), or of
+ * CONFIG_TILE_SIZE for the deterministic jobs, the last ones of
+ * a row or a column take the rest. The tiles are put in the row-major
+ * order, so the threads start from the contiguous blocks of them and steal
+ * the ones farthest from the blocks of the others.
+ */
+int catastrophe_loop_smp(catastrophe_t *catastrophe)
+{
+	int is_failed = 0;
+	unsigned int tiles_x, tiles_y, num_tiles, tile_idx, x, y;
+	unsigned int num_x, num_y, tile_x, tile_y, num_workers, i;
 
-	steps_per_core = catastrophe->parameter[pair.first].num_steps / cores;
+	struct parallel_job    job = { .workers = NULL };
+	struct parallel_tile  *tiles = NULL;
+	void                 **args = NULL;
+	long                  *results = NULL;
 
-	catastrophe_desc =
-		find_catastrophe_desc(catastrophe->sym_name);
-	if (!catastrophe_desc) {
-		WAVECAT_ERROR(-ENOMEM);
+	/* The pool is started by main(), or here on the first job */
+	if (thread_pool_start(0))
+		return -1;
+
+	job.master = catastrophe;
+	job.pair = catastrophe_search_alterable_params(catastrophe);
+	if (!catastrophe_is_pair_correct(&job.pair)) {
+		WAVECAT_ERROR(-1);
 		return -1;
 	}
 
-	thread_idx = cores;
-	while (thread_idx--) {
-		catastrophe->parameter[pair.first].min_value = p1_min;
-		p1_max = p1_step * steps_per_core + p1_min;
-		catastrophe->parameter[pair.first].max_value = p1_max;
-		catastrophe->parameter[pair.first].num_steps = steps_per_core;
-		p1_min = p1_max;
+	catastrophe_prepare_params(catastrophe, job.pair.first,
+			job.pair.second, 1);
 
-		new_cat = catastrophe_desc->fabric(catastrophe_desc,
-				catastrophe->parameter, catastrophe->deriv);
+	fprintf(stderr, "Catastrophe %s calculation.\n",
+			catastrophe->sym_name);
 
-		if (!new_cat) {
-			WAVECAT_ERROR(-1);
-			goto fail;
-		}
+	num_workers = thread_pool_size();
+	if (catastrophe->num_threads && catastrophe->num_threads < num_workers)
+		num_workers = catastrophe->num_threads;
 
-		tcatastrophe[thread_idx] = new_cat;
+	num_x = catastrophe->parameter[job.pair.first].num_steps;
+	num_y = catastrophe->parameter[job.pair.second].num_steps;
 
-		res = pthread_create(&thread[thread_idx], NULL,
-				parallel_loop_thread,
-				(void *) new_cat);
-		if (res) {
-			WAVECAT_ERROR(-1);
-			goto fail;
-		}
+	if (!catastrophe->deterministic &&
+	    parallel_subs_faster(catastrophe, num_x * num_y, num_workers)) {
+		fprintf(stderr, "[parallel] %u points, %u sub-integrations "
+				"of a point at once.\n", num_x * num_y,
+				catastrophe->descriptor->num_subs);
+
+		catastrophe->parallel_subs = 1;
+		is_failed = catastrophe_loop(catastrophe) != 0;
+		catastrophe->parallel_subs = 0;
+
+		goto out;
 	}
 
-	thread_idx = cores;
-	first_idx = 0;
-	while (thread_idx--) {
-		void *retval = NULL;
+	/* The same tiles for any number of the threads */
+	if (catastrophe->deterministic) {
+		tile_x = CONFIG_TILE_SIZE;
+		tile_y = CONFIG_TILE_SIZE;
+	} else {
+		parallel_tile_size(num_x, num_y, num_workers, &tile_x,
+				&tile_y);
+	}
+	tiles_x = (num_x + tile_x - 1) / tile_x;
+	tiles_y = (num_y + tile_y - 1) / tile_y;
+	num_tiles = tiles_x * tiles_y;
+
+	job.workers = calloc(num_workers, sizeof(*job.workers));
+	tiles = malloc(num_tiles * sizeof(*tiles));
+	args = malloc(num_tiles * sizeof(*args));
+	results = malloc(num_tiles * sizeof(*results));
+	if (!job.workers || !tiles || !args || !results) {
+		WAVECAT_ERROR(-ENOMEM);
+		is_failed = 1;
+		goto out;
+	}
 
-		res = pthread_join(thread[thread_idx], &retval);
-		if (res) {
-			WAVECAT_ERROR(-1);
-			goto fail;
-		}
+	for (x = 0, tile_idx = 0; x < tiles_x; x++) {
+		for (y = 0; y < tiles_y; y++, tile_idx++) {
+			struct parallel_tile *tile = &tiles[tile_idx];
 
-		if (retval)
-			is_failed = 1;
+			tile->job     = &job;
+			tile->first_x = x * tile_x;
+			tile->num_x   = (x == tiles_x - 1) ?
+				num_x - tile->first_x : tile_x;
+			tile->first_y = y * tile_y;
+			tile->num_y   = (y == tiles_y - 1) ?
+				num_y - tile->first_y : tile_y;
+
+			args[tile_idx] = tile;
+		}
+	}
 
-		copy_part_point_array(catastrophe->point_array,
-				tcatastrophe[thread_idx]->point_array,
-				first_idx);
-		first_idx +=
-			tcatastrophe[thread_idx]->point_array->num_steps_x;
+	fprintf(stderr, "[parallel] %u tiles of %ux%u points.\n",
+			num_tiles, tile_x, tile_y);
 
-		destruct_catastrophe(tcatastrophe[thread_idx]);
+	if (thread_pool_run(parallel_loop_item, args, results, num_tiles,
+				num_workers)) {
+		is_failed = 1;
+		goto out;
 	}
 
-	if (is_failed)
-		goto fail;
+	for (tile_idx = 0; tile_idx < num_tiles; tile_idx++) {
+		if (results[tile_idx])
+			is_failed = 1;
+	}
 
-	return 0;
+	for (i = 0; i < num_workers; i++)
+		if (job.workers[i])
+			integration_stats_merge(&catastrophe->stats,
+					&job.workers[i]->stats);
+
+out:
+	for (i = 0; job.workers && i < num_workers; i++)
+		destruct_catastrophe(job.workers[i]);
+	free(job.workers);
+	free(tiles);
+	free(args);
+	free(results);
+
+#ifdef CONFIG_CACHE_RESULT
+	/* No thread of the pool searches the caches now */
+	simple_cache_reclaim();
+#endif
 
-fail:
-	return -1;
+	return is_failed ? -1 : 0;
 }
 
 static void catastrophe_parallel(void) __attribute__((constructor));
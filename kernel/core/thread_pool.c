@@ -0,0 +1,578 @@
+/**
+ * kernel/core/thread_pool.c - process-wide pool of computational threads.
+ *
+ * NOTES:
+ *
+ * The threads are created once: when the SCGI server starts, or on the
+ * first job in the other modes. A job is a set of items passed to the same
+ * function, the submitter sleeps until the last one is done. Only one job is
+ * run at a time.
+ *
+ * The items are scheduled by work stealing: every thread gets a deque with
+ * an even share of the items, takes them from the head and, when its deque
+ * is empty, steals from the tail of the others. The items are given out as
+ * contiguous ranges, so a deque is a range of indices and stays one after a
+ * steal: the neighbouring items are processed by the same thread unless the
+ * load is unbalanced.
+ *
+ * By default there is a thread per CPU the process may run on, limited by
+ * the CPU quota of the cgroup in containers.
+ *
+ * The threads are not pinned unless an affinity is set. Pinned threads are
+ * grouped by the NUMA nodes of their CPUs, and a thread out of items steals
+ * from the threads of its own node first. The grid and the state of a
+ * thread are first touched by the thread computing them, so they stay on
+ * its node.
+ */
+
+#define _GNU_SOURCE
+
+#include <kernel/core/thread_pool.h>
+#include <kernel/core/config.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <dirent.h>
+#include <unistd.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+
+/* Items [head, tail) of the job left to the thread, one cache line each */
+struct thread_pool_deque {
+	pthread_spinlock_t lock;
+	unsigned int       head;
+	unsigned int       tail;
+	/* NUMA node of the CPU the thread is pinned to */
+	int                node;
+} __attribute__ ((aligned (64)));
+
+struct thread_pool {
+	pthread_mutex_t    lock;
+	/* Signalled when a job is submitted or the pool is stopped */
+	pthread_cond_t     work_cond;
+	/* Signalled when the job is done and the threads have left it */
+	pthread_cond_t     done_cond;
+	/* Serializes the jobs */
+	pthread_mutex_t    run_lock;
+
+	pthread_t         *threads;
+	struct thread_pool_deque *deques;
+	unsigned int       num_threads;
+	thread_pool_affinity_t affinity;
+	/* Threads taking part in the current job and the ones still in it */
+	unsigned int       num_active;
+	unsigned int       num_busy;
+	int                stop;
+
+	thread_pool_func_t func;
+	void             **args;
+	long              *results;
+	unsigned int       num_items;
+	unsigned int       done_items;
+	/* Incremented on every job, the threads sleep until it changes */
+	unsigned long      generation;
+};
+
+/* Index of the thread in the pool, zero in the other threads */
+static __thread unsigned int thread_pool_index;
+/* Nonzero in the threads of the pool */
+static __thread int thread_pool_member;
+
+static struct thread_pool pool = {
+	.lock      = PTHREAD_MUTEX_INITIALIZER,
+	.work_cond = PTHREAD_COND_INITIALIZER,
+	.done_cond = PTHREAD_COND_INITIALIZER,
+	.run_lock  = PTHREAD_MUTEX_INITIALIZER,
+};
+
+static int thread_pool_pop(struct thread_pool_deque *deque,
+		unsigned int *item)
+{
+	int found = 0;
+
+	pthread_spin_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		*item = deque->head++;
+		found = 1;
+	}
+	pthread_spin_unlock(&deque->lock);
+
+	return found;
+}
+
+static int thread_pool_steal(struct thread_pool_deque *deque,
+		unsigned int *item)
+{
+	int found = 0;
+
+	pthread_spin_lock(&deque->lock);
+	if (deque->head < deque->tail) {
+		*item = --deque->tail;
+		found = 1;
+	}
+	pthread_spin_unlock(&deque->lock);
+
+	return found;
+}
+
+/* Next item of the own deque or, once it is empty, one stolen from another */
+static int thread_pool_take(unsigned int self, unsigned int *item)
+{
+	struct thread_pool_deque *victim;
+	unsigned int i;
+	int local;
+
+	if (thread_pool_pop(&pool.deques[self], item))
+		return 1;
+
+	/* The threads of the same node first, then the others */
+	for (local = 1; local >= 0; local--) {
+		for (i = 1; i < pool.num_active; i++) {
+			victim = &pool.deques[(self + i) % pool.num_active];
+			if ((victim->node == pool.deques[self].node) != local)
+				continue;
+			if (thread_pool_steal(victim, item))
+				return 1;
+		}
+	}
+
+	return 0;
+}
+
+static void thread_pool_work(unsigned int self)
+{
+	unsigned int item;
+	long res;
+
+	while (thread_pool_take(self, &item)) {
+		res = pool.func(pool.args[item]);
+
+		pthread_mutex_lock(&pool.lock);
+		pool.results[item] = res;
+		if (++pool.done_items == pool.num_items)
+			pthread_cond_signal(&pool.done_cond);
+		pthread_mutex_unlock(&pool.lock);
+	}
+}
+
+static void *thread_pool_worker(void *param)
+{
+	unsigned int self = (unsigned long) param;
+	unsigned long generation = 0;
+
+	thread_pool_index = self;
+	thread_pool_member = 1;
+
+	pthread_mutex_lock(&pool.lock);
+	for (;;) {
+		while (!pool.stop && pool.generation == generation)
+			pthread_cond_wait(&pool.work_cond, &pool.lock);
+		if (pool.stop)
+			break;
+
+		generation = pool.generation;
+		if (self >= pool.num_active)
+			continue;
+
+		pool.num_busy++;
+		pthread_mutex_unlock(&pool.lock);
+		thread_pool_work(self);
+		pthread_mutex_lock(&pool.lock);
+		if (!--pool.num_busy)
+			pthread_cond_signal(&pool.done_cond);
+	}
+	pthread_mutex_unlock(&pool.lock);
+
+	return NULL;
+}
+
+/*
+ * CPUs granted by the quota of the cgroup v2 or v1 of the process, rounded
+ * up, or zero if there is no quota.
+ */
+static unsigned int thread_pool_cgroup_cpus(void)
+{
+	FILE *file;
+	char quota_str[32];
+	long quota = -1, period = 0;
+
+	file = fopen("/sys/fs/cgroup/cpu.max", "r");
+	if (file) {
+		if (2 == fscanf(file, "%31s %ld", quota_str, &period) &&
+				strcmp(quota_str, "max"))
+			quota = atol(quota_str);
+		fclose(file);
+	} else {
+		file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_quota_us", "r");
+		if (file) {
+			if (1 != fscanf(file, "%ld", &quota))
+				quota = -1;
+			fclose(file);
+		}
+		file = fopen("/sys/fs/cgroup/cpu/cpu.cfs_period_us", "r");
+		if (file) {
+			if (1 != fscanf(file, "%ld", &period))
+				period = 0;
+			fclose(file);
+		}
+	}
+
+	if (quota <= 0 || period <= 0)
+		return 0;
+
+	return (quota + period - 1) / period;
+}
+
+/* NUMA node of the CPU, zero if the topology is not known */
+static int thread_pool_cpu_node(int cpu)
+{
+	char path[64];
+	DIR *dir;
+	struct dirent *entry;
+	int node = 0;
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	dir = opendir(path);
+	if (!dir)
+		return 0;
+
+	while ((entry = readdir(dir)))
+		if (1 == sscanf(entry->d_name, "node%d", &node))
+			break;
+
+	closedir(dir);
+	return node;
+}
+
+/*
+ * Order the CPUs of the affinity mask for the placement, the thread i is
+ * pinned to cpus[i % num_cpus].
+ *
+ * Returns the number of the CPUs.
+ */
+static unsigned int thread_pool_order_cpus(thread_pool_affinity_t affinity,
+		int *cpus, int *nodes)
+{
+	cpu_set_t set;
+	int rank[CPU_SETSIZE];
+	int cpu, node, key, j;
+	unsigned int num_cpus = 0, i;
+
+	CPU_ZERO(&set);
+	if (sched_getaffinity(0, sizeof(set), &set))
+		return 0;
+
+	for (cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+		if (!CPU_ISSET(cpu, &set))
+			continue;
+		cpus[num_cpus] = cpu;
+		nodes[num_cpus] = thread_pool_cpu_node(cpu);
+		num_cpus++;
+	}
+
+	/*
+	 * Compact: by the node, then by the number. Scatter: the first CPUs of
+	 * all the nodes, then the second ones, and so on. Both are insertion
+	 * sorts, stable and cheap for the counts of CPUs of a machine.
+	 */
+	for (i = 1; i < num_cpus; i++) {
+		cpu = cpus[i];
+		node = nodes[i];
+		for (j = i - 1; j >= 0 && nodes[j] > node; j--) {
+			cpus[j + 1] = cpus[j];
+			nodes[j + 1] = nodes[j];
+		}
+		cpus[j + 1] = cpu;
+		nodes[j + 1] = node;
+	}
+
+	if (affinity != AFFINITY_SCATTER)
+		return num_cpus;
+
+	for (i = 0; i < num_cpus; i++)
+		rank[i] = (i && nodes[i] == nodes[i - 1]) ? rank[i - 1] + 1 : 0;
+
+	for (i = 1; i < num_cpus; i++) {
+		cpu = cpus[i];
+		node = nodes[i];
+		key = rank[i];
+		for (j = i - 1; j >= 0 && rank[j] > key; j--) {
+			cpus[j + 1] = cpus[j];
+			nodes[j + 1] = nodes[j];
+			rank[j + 1] = rank[j];
+		}
+		cpus[j + 1] = cpu;
+		nodes[j + 1] = node;
+		rank[j + 1] = key;
+	}
+
+	return num_cpus;
+}
+
+/**
+ * thread_pool_detect_size() - number of the CPUs available to the process
+ *
+ * The CPUs of the affinity mask, or the online ones if the mask is not
+ * available, limited by the CPU quota of the cgroup.
+ */
+unsigned int thread_pool_detect_size(void)
+{
+	cpu_set_t set;
+	long online;
+	unsigned int num_cpus = 0, quota_cpus;
+
+	CPU_ZERO(&set);
+	if (!sched_getaffinity(0, sizeof(set), &set))
+		num_cpus = CPU_COUNT(&set);
+
+	if (!num_cpus) {
+		online = sysconf(_SC_NPROCESSORS_ONLN);
+		num_cpus = (online > 0) ? online : 1;
+	}
+
+	quota_cpus = thread_pool_cgroup_cpus();
+	if (quota_cpus && quota_cpus < num_cpus)
+		num_cpus = quota_cpus;
+
+	return num_cpus;
+}
+
+/**
+ * thread_pool_set_affinity() - pin the threads of the pool to the CPUs
+ * @affinity placement of the threads, AFFINITY_NONE to leave them unpinned
+ *
+ * Returns 0 on success and -1 if the pool is already started.
+ */
+int thread_pool_set_affinity(thread_pool_affinity_t affinity)
+{
+	int err = 0;
+
+	pthread_mutex_lock(&pool.lock);
+	if (pool.num_threads)
+		err = -1;
+	else
+		pool.affinity = affinity;
+	pthread_mutex_unlock(&pool.lock);
+
+	return err;
+}
+
+/**
+ * thread_pool_start() - create the threads of the pool
+ * @num_threads number of the threads, zero to detect the number of CPUs
+ *
+ * Does nothing if the pool is already started.
+ *
+ * Returns 0 on success and -1 if no thread could be created.
+ */
+int thread_pool_start(unsigned int num_threads)
+{
+	static int cpus[CPU_SETSIZE], nodes[CPU_SETSIZE];
+	unsigned int i, j, num_cpus = 0, num_nodes;
+	pthread_attr_t attr;
+	cpu_set_t set;
+	int err = 0;
+
+	pthread_mutex_lock(&pool.lock);
+
+	if (pool.num_threads)
+		goto out;
+
+	if (!num_threads)
+		num_threads = thread_pool_detect_size();
+
+	pool.threads = malloc(num_threads * sizeof(*pool.threads));
+	if (posix_memalign((void **) &pool.deques,
+				__alignof__(struct thread_pool_deque),
+				num_threads * sizeof(*pool.deques)))
+		pool.deques = NULL;
+	if (!pool.threads || !pool.deques) {
+		err = -1;
+		goto out_free;
+	}
+
+	for (i = 0; i < num_threads; i++) {
+		pthread_spin_init(&pool.deques[i].lock,
+				PTHREAD_PROCESS_PRIVATE);
+		pool.deques[i].head = pool.deques[i].tail = 0;
+		pool.deques[i].node = 0;
+	}
+
+	if (pool.affinity)
+		num_cpus = thread_pool_order_cpus(pool.affinity, cpus, nodes);
+
+	pool.stop = 0;
+	for (i = 0; i < num_threads; i++) {
+		/* The thread starts on its CPU, before touching any memory */
+		pthread_attr_init(&attr);
+		if (num_cpus) {
+			CPU_ZERO(&set);
+			CPU_SET(cpus[i % num_cpus], &set);
+			pthread_attr_setaffinity_np(&attr, sizeof(set), &set);
+			pool.deques[i].node = nodes[i % num_cpus];
+		}
+
+		err = pthread_create(&pool.threads[i], &attr,
+				thread_pool_worker, (void *) (unsigned long) i);
+		pthread_attr_destroy(&attr);
+		if (err) {
+			err = 0;
+			break;
+		}
+		pool.num_threads++;
+	}
+
+	if (!pool.num_threads) {
+		err = -1;
+		goto out_free;
+	}
+
+	fprintf(stderr, "[pool] %u computational threads started.\n",
+			pool.num_threads);
+	if (num_cpus) {
+		for (i = 0, num_nodes = 0; i < pool.num_threads; i++) {
+			for (j = 0; j < i; j++)
+				if (pool.deques[j].node == pool.deques[i].node)
+					break;
+			num_nodes += (j == i);
+		}
+		fprintf(stderr, "[pool] Threads are pinned %s over %u "
+				"NUMA node(s).\n",
+				(pool.affinity == AFFINITY_SCATTER) ?
+				"scattered" : "compactly", num_nodes);
+	}
+	goto out;
+
+out_free:
+	free(pool.threads);
+	free(pool.deques);
+	pool.threads = NULL;
+	pool.deques = NULL;
+out:
+	pthread_mutex_unlock(&pool.lock);
+	if (err)
+		WAVECAT_ERROR(err);
+	return err;
+}
+
+/**
+ * thread_pool_stop() - wait for the threads of the pool to exit
+ *
+ * Must not be called while a job is run.
+ */
+void thread_pool_stop(void)
+{
+	unsigned int i, num_threads;
+
+	pthread_mutex_lock(&pool.lock);
+	pool.stop = 1;
+	num_threads = pool.num_threads;
+	pthread_cond_broadcast(&pool.work_cond);
+	pthread_mutex_unlock(&pool.lock);
+
+	for (i = 0; i < num_threads; i++)
+		pthread_join(pool.threads[i], NULL);
+
+	pthread_mutex_lock(&pool.lock);
+	for (i = 0; i < num_threads; i++)
+		pthread_spin_destroy(&pool.deques[i].lock);
+	free(pool.threads);
+	free(pool.deques);
+	pool.threads = NULL;
+	pool.deques = NULL;
+	pool.num_threads = 0;
+	pthread_mutex_unlock(&pool.lock);
+}
+
+/**
+ * thread_pool_size() - number of the threads, zero if not started
+ */
+unsigned int thread_pool_size(void)
+{
+	unsigned int num_threads;
+
+	pthread_mutex_lock(&pool.lock);
+	num_threads = pool.num_threads;
+	pthread_mutex_unlock(&pool.lock);
+
+	return num_threads;
+}
+
+/**
+ * thread_pool_self() - index of the calling thread in the pool
+ *
+ * The index is below thread_pool_size() and, in the functions run by a job,
+ * below the max_threads of thread_pool_run(), so the functions may keep the
+ * state of a thread in an array. Zero outside the threads of the pool.
+ */
+unsigned int thread_pool_self(void)
+{
+	return thread_pool_index;
+}
+
+/**
+ * thread_pool_run() - run a job and wait for its completion
+ * @func      function run by the threads
+ * @args      arguments of the items, func is called once for each one
+ * @results   values returned by func for the items
+ * @num_items number of the items
+ * @max_threads number of the threads to run the items, zero for all of them
+ *
+ * A job submitted by an item of another one is run by the submitting thread
+ * alone, the others may be waiting for the outer job.
+ *
+ * Returns 0 on success and -1 if the pool is not started.
+ */
+int thread_pool_run(thread_pool_func_t func, void **args, long *results,
+		unsigned int num_items, unsigned int max_threads)
+{
+	struct thread_pool_deque *deque;
+	unsigned int i;
+
+	if (!thread_pool_size()) {
+		WAVECAT_ERROR(-1);
+		return -1;
+	}
+
+	if (!num_items)
+		return 0;
+
+	if (thread_pool_member) {
+		for (i = 0; i < num_items; i++)
+			results[i] = func(args[i]);
+		return 0;
+	}
+
+	pthread_mutex_lock(&pool.run_lock);
+	pthread_mutex_lock(&pool.lock);
+
+	pool.func       = func;
+	pool.args       = args;
+	pool.results    = results;
+	pool.done_items = 0;
+	pool.num_items  = num_items;
+	pool.num_active = pool.num_threads;
+	if (max_threads && max_threads < pool.num_active)
+		pool.num_active = max_threads;
+
+	for (i = 0; i < pool.num_active; i++) {
+		deque = &pool.deques[i];
+		pthread_spin_lock(&deque->lock);
+		deque->head = (unsigned long) num_items * i / pool.num_active;
+		deque->tail = (unsigned long) num_items * (i + 1) /
+			pool.num_active;
+		pthread_spin_unlock(&deque->lock);
+	}
+
+	pool.generation++;
+	pthread_cond_broadcast(&pool.work_cond);
+	/* No thread may still look at the deques when the next job starts */
+	while (pool.done_items < pool.num_items || pool.num_busy)
+		pthread_cond_wait(&pool.done_cond, &pool.lock);
+
+	pthread_mutex_unlock(&pool.lock);
+	pthread_mutex_unlock(&pool.run_lock);
+
+	return 0;
+}
@@ -0,0 +1,237 @@
+/**
+ * kernel/integration/bulirsch_stoer.c - implementation of the
+ * Gragg-Bulirsch-Stoer method with automatic step size and order control to
+ * integrate systems of ordinary differential equations (ODE).
+ *
+ * NOTES:
+ *
+ * The same as cmplx_bulirsch_stoer_tol() for the systems with real values,
+ * see the notes in kernel/integration/cmplx_bulirsch_stoer.c.
+ */
+
+#include <kernel/integration/bulirsch_stoer.h>
+
+#include <math.h>
+
+#define BS_MAX_COLUMNS   8
+#define BS_SAFETY        0.94
+#define BS_REDUCTION     0.65
+#define BS_MIN_FACTOR    0.2
+#define BS_MAX_FACTOR    4.0
+
+static const unsigned int bs_substeps[BS_MAX_COLUMNS] = {
+	2, 4, 6, 8, 10, 12, 14, 16
+};
+
+/*
+ * Modified midpoint rule with num substeps over [t, t + h], f0 is the value
+ * of the function at the start. Takes num - 1 evaluations of the function
+ * besides the final one.
+ */
+static void bulirsch_stoer_midpoint(catastrophe_t *const cat,
+		const double t, const double h, const unsigned int num,
+		const unsigned int n, const double *y,
+		const double *f0, double *res)
+{
+	equation_t *equation = cat->equation;
+	double z0[CONFIG_CAT_MAX_EQUATIONS];
+	double z1[CONFIG_CAT_MAX_EQUATIONS];
+	double f[CONFIG_CAT_MAX_EQUATIONS] = { 0 };
+	double z;
+	double hs = h / num;
+	unsigned int i, m;
+
+	for (i = 0; i < n; i++) {
+		z0[i] = y[i];
+		z1[i] = y[i] + hs * f0[i];
+	}
+
+	for (m = 1; m < num; m++) {
+		equation->function(cat, t + m * hs, z1, f);
+		for (i = 0; i < n; i++) {
+			z = z0[i] + 2.0 * hs * f[i];
+			z0[i] = z1[i];
+			z1[i] = z;
+		}
+	}
+
+	equation->function(cat, t + h, z1, f);
+	for (i = 0; i < n; i++)
+		res[i] = 0.5 * (z0[i] + z1[i] + hs * f[i]);
+}
+
+/**
+ * bulirsch_stoer_tol() - extrapolation method for non-complex systems
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @abs_tol     absolute tolerance of the local error
+ * @rel_tol     relative tolerance of the local error
+ * @catastrophe pointer to a catastrophe descriptor
+ * @stats       work done by the call, may be NULL
+ *
+ * Returns 0 on success and -1 if the step size has collapsed or the limit of
+ * steps is reached, the resulting vector holds the last accepted values then.
+ */
+int bulirsch_stoer_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats)
+{
+	equation_t *equation;
+
+	double table[BS_MAX_COLUMNS][BS_MAX_COLUMNS]
+		[CONFIG_CAT_MAX_EQUATIONS];
+	double  y[CONFIG_CAT_MAX_EQUATIONS];
+	double f0[CONFIG_CAT_MAX_EQUATIONS] = { 0 };
+
+	double factor[BS_MAX_COLUMNS];
+	double work[BS_MAX_COLUMNS];
+
+	double t, h, h_min, err, sc, ratio;
+	double e;
+	unsigned long accepted = 0, rejected = 0, evaluations = 0;
+	unsigned int i, j, k, k_max, n, kopt = 4;
+	int converged, ret = 0;
+
+	equation = cat->equation;
+	n = equation->num_equations;
+
+	for (i = 0; i < n; i++)
+		y[i] = equation->initial_vector[i];
+
+	/* Evaluations of the function needed to build the k-th row */
+	work[0] = bs_substeps[0] + 1;
+	for (k = 1; k < BS_MAX_COLUMNS; k++)
+		work[k] = work[k - 1] + bs_substeps[k];
+
+	t = start;
+	h = (step > 0 && step < end - start) ? step : end - start;
+	h_min = 1e-12 * fmax(1.0, fabs(end));
+
+	while (end - t > h_min) {
+		if (t + h > end)
+			h = end - t;
+
+		equation->function(cat, t, y, f0);
+		evaluations++;
+
+		k_max = (kopt + 1 < BS_MAX_COLUMNS) ? kopt + 1 :
+			BS_MAX_COLUMNS - 1;
+		converged = 0;
+
+		for (k = 0; k <= k_max; k++) {
+			bulirsch_stoer_midpoint(cat, t, h,
+					bs_substeps[k], n, y, f0, table[k][0]);
+			evaluations += bs_substeps[k];
+
+			for (j = 1; j <= k; j++) {
+				ratio = (double) bs_substeps[k] /
+					bs_substeps[k - j];
+				ratio = ratio * ratio - 1.0;
+				for (i = 0; i < n; i++)
+					table[k][j][i] = table[k][j - 1][i] +
+						(table[k][j - 1][i] -
+						 table[k - 1][j - 1][i]) /
+						ratio;
+			}
+
+			if (k == 0)
+				continue;
+
+			/* Root mean square of the error scaled by the tolerance */
+			err = 0.0;
+			for (i = 0; i < n; i++) {
+				e = table[k][k][i] - table[k][k - 1][i];
+				sc = abs_tol + rel_tol * fmax(fabs(y[i]),
+						fabs(table[k][k][i]));
+				err += (fabs(e) / sc) * (fabs(e) / sc);
+			}
+			err = sqrt(err / n);
+
+			factor[k] = (err > 0.0) ? BS_SAFETY *
+				pow(BS_REDUCTION / err, 1.0 / (2 * k + 1)) :
+				BS_MAX_FACTOR;
+			factor[k] = fmin(BS_MAX_FACTOR,
+					fmax(BS_MIN_FACTOR, factor[k]));
+
+			if (err <= 1.0 && k + 1 >= kopt) {
+				converged = 1;
+				break;
+			}
+		}
+
+		if (converged) {
+			t += h;
+			for (i = 0; i < n; i++)
+				y[i] = table[k][k][i];
+			accepted++;
+
+			/* The order with the least work per unit of t */
+			kopt = 1;
+			for (j = 2; j <= k; j++)
+				if (work[j] / factor[j] <
+						work[kopt] / factor[kopt])
+					kopt = j;
+
+			/*
+			 * The last column was the best one, the next order is
+			 * tried with the step scaled by the additional work.
+			 */
+			if (kopt == k && k + 1 < BS_MAX_COLUMNS) {
+				h *= factor[k] * work[k + 1] / work[k];
+				kopt = k + 1;
+			} else {
+				h *= factor[kopt];
+			}
+		} else {
+			rejected++;
+
+			h *= factor[k_max];
+		}
+
+		if ((h < h_min && t + h_min < end) ||
+				accepted + rejected >=
+				CONFIG_INTEGRATION_MAX_STEPS) {
+			ret = -1;
+			break;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		equation->resulting_vector[i] = y[i];
+	}
+
+	INTEGRATION_STATS_ADD(&cat->stats, 1, accepted, rejected, evaluations);
+
+	if (stats) {
+		stats->integrations = 1;
+		stats->accepted     = accepted;
+		stats->rejected     = rejected;
+		stats->evaluations  = evaluations;
+	}
+
+	return ret;
+}
+
+/**
+ * bulirsch_stoer() - extrapolation method with the interface of
+ * runge_kutta()
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @catastrophe pointer to a catastrophe descriptor
+ *
+ * The tolerances of the job or the default ones from kernel/core/config.h
+ * are used, see catastrophe_abs_tol(). A failed integration cancels the
+ * job, the resulting vector must not be taken as the point then.
+ */
+void bulirsch_stoer(const double start, const double end,
+		const double step, catastrophe_t *const cat)
+{
+	if (bulirsch_stoer_tol(start, end, step,
+				catastrophe_abs_tol(cat),
+				catastrophe_rel_tol(cat), cat, NULL)) {
+		WAVECAT_ERROR(-1);
+		catastrophe_cancel(cat, CANCEL_FAILED);
+	}
+}
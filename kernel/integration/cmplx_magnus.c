@@ -0,0 +1,194 @@
+/**
+ * kernel/integration/cmplx_magnus.c - implementation of the 4th order Magnus
+ * method to integrate linear systems of ordinary differential equations (ODE)
+ * with complex values.
+ *
+ * NOTES:
+ *
+ * The functions of the catastrophes are affine in y: f = A(t) y + b(t). The
+ * matrix and the forcing term are obtained by evaluating the function with
+ * the zero vector and the basis vectors. The system is extended with the
+ * constant component 1, so that the forcing term becomes a column of the
+ * matrix, and every step multiplies the solution by the exponent of
+ *
+ *   Omega = h / 2 (A1 + A2) + sqrt(3) / 12 h^2 (A2 A1 - A1 A2),
+ *
+ * A1 and A2 are the matrices in the Gauss points of the step. The method is
+ * stable for the oscillating solutions far from the origin, so the steps are
+ * limited by the accuracy only.
+ */
+
+#include <kernel/integration/cmplx_magnus.h>
+
+#include <math.h>
+
+#define M (CONFIG_MAGNUS_MAX_EQUATIONS + 1)
+
+/*
+ * Columns of the matrix are the differences of the function at the basis
+ * vectors and at zero, the last column is the forcing term.
+ */
+static void cmplx_magnus_matrix(catastrophe_t *const cat, const double t,
+		const unsigned int n, double complex (*a)[M])
+{
+	cmplx_equation_t *equation = cat->equation;
+	double complex y[CONFIG_CAT_MAX_EQUATIONS] = { 0 };
+	double complex b[CONFIG_CAT_MAX_EQUATIONS] = { 0 };
+	double complex f[CONFIG_CAT_MAX_EQUATIONS];
+	unsigned int i, j;
+
+	equation->function(cat, t, y, b);
+
+	for (j = 0; j < n; j++) {
+		for (i = 0; i < n; i++)
+			f[i] = 0;
+		y[j] = 1.0;
+		equation->function(cat, t, y, f);
+		y[j] = 0;
+
+		for (i = 0; i < n; i++)
+			a[i][j] = f[i] - b[i];
+	}
+
+	for (i = 0; i < n; i++) {
+		a[i][n] = b[i];
+		a[n][i] = 0;
+	}
+	a[n][n] = 0;
+}
+
+static void cmplx_magnus_mul(const unsigned int m, double complex (*a)[M],
+		double complex (*b)[M], double complex (*c)[M])
+{
+	unsigned int i, j, k;
+
+	for (i = 0; i < m; i++) {
+		for (j = 0; j < m; j++)
+			c[i][j] = 0;
+		for (k = 0; k < m; k++)
+			for (j = 0; j < m; j++)
+				c[i][j] += a[i][k] * b[k][j];
+	}
+}
+
+/*
+ * Exponent of the matrix by scaling and squaring, the scaled matrix has the
+ * norm below 1/2 and the Taylor series is truncated after the 12th term.
+ */
+static void cmplx_magnus_exp(const unsigned int m, double complex (*a)[M],
+		double complex (*e)[M])
+{
+	double complex x[M][M], t[M][M];
+	double norm = 0, sum, scale;
+	unsigned int i, j, k, s = 0;
+
+	for (j = 0; j < m; j++) {
+		for (i = 0, sum = 0; i < m; i++)
+			sum += cabs(a[i][j]);
+		norm = fmax(norm, sum);
+	}
+
+	if (norm > 0.5)
+		s = (unsigned int) ceil(log2(norm / 0.5));
+	scale = ldexp(1.0, -(int) s);
+
+	for (i = 0; i < m; i++)
+		for (j = 0; j < m; j++)
+			x[i][j] = a[i][j] * scale;
+
+	/* Horner scheme: e = I + x (I + x / 2 (I + ... (I + x / 12))) */
+	for (i = 0; i < m; i++)
+		for (j = 0; j < m; j++)
+			e[i][j] = (i == j);
+
+	for (k = 12; k > 0; k--) {
+		cmplx_magnus_mul(m, x, e, t);
+		for (i = 0; i < m; i++)
+			for (j = 0; j < m; j++)
+				e[i][j] = (i == j) + t[i][j] / k;
+	}
+
+	while (s--) {
+		cmplx_magnus_mul(m, e, e, t);
+		for (i = 0; i < m; i++)
+			for (j = 0; j < m; j++)
+				e[i][j] = t[i][j];
+	}
+}
+
+/**
+ * cmplx_magnus() - 4th order Magnus method for linear complex systems
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        step
+ * @catastrophe pointer to a catastrophe descriptor
+ *
+ * The function of the equation must be affine in y and the system must have
+ * at most CONFIG_MAGNUS_MAX_EQUATIONS equations, the last step is shortened
+ * to stop exactly at the end.
+ */
+void cmplx_magnus(const double start, const double end, const double step,
+		catastrophe_t *const cat)
+{
+	cmplx_equation_t *equation;
+
+	double complex a1[M][M], a2[M][M], c1[M][M], c2[M][M];
+	double complex omega[M][M], e[M][M];
+	double complex y[M], y1[M];
+
+	const double g1 = 0.5 - sqrt(3.0) / 6.0;
+	const double g2 = 0.5 + sqrt(3.0) / 6.0;
+
+	double t, h, h_min;
+	unsigned long steps = 0;
+	unsigned int i, j, n, m;
+
+	equation = cat->equation;
+	n = equation->num_equations;
+	m = n + 1;
+
+	assert(n <= CONFIG_MAGNUS_MAX_EQUATIONS);
+
+	for (i = 0; i < n; i++)
+		y[i] = equation->initial_vector[i];
+	y[n] = 1.0;
+
+	t = start;
+	h_min = 1e-12 * fmax(1.0, fabs(end));
+
+	while (end - t > h_min) {
+		h = (t + step > end) ? end - t : step;
+
+		cmplx_magnus_matrix(cat, t + g1 * h, n, a1);
+		cmplx_magnus_matrix(cat, t + g2 * h, n, a2);
+
+		cmplx_magnus_mul(m, a2, a1, c1);
+		cmplx_magnus_mul(m, a1, a2, c2);
+
+		for (i = 0; i < m; i++)
+			for (j = 0; j < m; j++)
+				omega[i][j] = h / 2.0 * (a1[i][j] + a2[i][j]) +
+					sqrt(3.0) / 12.0 * h * h *
+					(c1[i][j] - c2[i][j]);
+
+		cmplx_magnus_exp(m, omega, e);
+
+		for (i = 0; i < m; i++) {
+			y1[i] = 0;
+			for (j = 0; j < m; j++)
+				y1[i] += e[i][j] * y[j];
+		}
+		for (i = 0; i < n; i++)
+			y[i] = y1[i];
+
+		t += h;
+		steps++;
+	}
+
+	for (i = 0; i < n; i++) {
+		equation->resulting_vector[i] = y[i];
+	}
+
+	/* Two matrices of n + 1 evaluations each per step */
+	INTEGRATION_STATS_ADD(&cat->stats, 1, steps, 0, 2 * m * steps);
+}
@@ -37,6 +37,7 @@ void cmplx_runge_kutta(const double start, const double end, const double step,
 	double complex y1[CONFIG_CAT_MAX_EQUATIONS];
 
 	double t, cur_t;
+	unsigned long steps = 0;
 	unsigned int i;
 
 	equation = cat->equation;
@@ -76,9 +77,12 @@ void cmplx_runge_kutta(const double start, const double end, const double step,
 		}
 
 		t += step;
+		steps++;
 	}
 
 	for (i = 0; i < equation->num_equations; i++) {
 		equation->resulting_vector[i] = y[i];
 	}
+
+	INTEGRATION_STATS_ADD(&cat->stats, 1, steps, 0, 4 * steps);
 }
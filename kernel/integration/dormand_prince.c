@@ -0,0 +1,237 @@
+/**
+ * kernel/integration/dormand_prince.c - implementation of the Dormand-Prince
+ * 5(4) embedded Runge-Kutta method with automatic step size control to
+ * integrate systems of ordinary differential equations (ODE).
+ *
+ * NOTES:
+ *
+ * The step is accepted when the difference between the 5th and the embedded
+ * 4th order solutions is within the tolerance, the solution is propagated
+ * with the 5th order one (local extrapolation). Smooth parts of the path are
+ * passed with a few large steps, oscillating ones with many small steps.
+ *
+ * An additional memory is allocated on the call stack because of performance
+ * reasons only, in the same way as it is done by runge_kutta().
+ */
+
+#include <kernel/integration/dormand_prince.h>
+#include <kernel/integration/dormand_prince_tableau.h>
+
+#include <math.h>
+
+/**
+ * dormand_prince_dense() - adaptive method for non-complex systems with
+ * dense output
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @abs_tol     absolute tolerance of the local error
+ * @rel_tol     relative tolerance of the local error
+ * @catastrophe pointer to a catastrophe descriptor
+ * @stats       work done by the call, may be NULL
+ * @dense_t     ascending values of the t variable inside [start, end] to
+ *              save the solution at, may be NULL
+ * @num_dense   number of the values in dense_t
+ * @dense_vector solutions at the points of dense_t
+ * @num_saved   returns the number of the first values of dense_t the
+ *              solution is saved at, may be NULL
+ *
+ * The solution between the ends of an accepted step is computed with the
+ * continuous extension of the method, it costs no additional evaluations of
+ * the function. The step reaching the end saves the rest of dense_t, so all
+ * of them are saved on success.
+ *
+ * Returns 0 on success and -1 if the step size has collapsed or the limit of
+ * steps is reached, the resulting vector holds the last accepted values then.
+ */
+int dormand_prince_dense(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats,
+		const double *dense_t, const unsigned int num_dense,
+		double (*dense_vector)[CONFIG_CAT_MAX_EQUATIONS],
+		unsigned int *num_saved)
+{
+	equation_t *equation;
+
+	double k1[CONFIG_CAT_MAX_EQUATIONS];
+	double k2[CONFIG_CAT_MAX_EQUATIONS];
+	double k3[CONFIG_CAT_MAX_EQUATIONS];
+	double k4[CONFIG_CAT_MAX_EQUATIONS];
+	double k5[CONFIG_CAT_MAX_EQUATIONS];
+	double k6[CONFIG_CAT_MAX_EQUATIONS];
+	double k7[CONFIG_CAT_MAX_EQUATIONS];
+	double  y[CONFIG_CAT_MAX_EQUATIONS];
+	double y1[CONFIG_CAT_MAX_EQUATIONS];
+	double y5[CONFIG_CAT_MAX_EQUATIONS];
+
+	double t, h, h_min, err, sc, e, factor;
+	unsigned long accepted = 0, rejected = 0, evaluations;
+	double w1, w3, w4, w5, w6, w7;
+	unsigned int i, n, d = 0;
+	int ret = 0;
+
+	equation = cat->equation;
+	n = equation->num_equations;
+
+	/*
+	 * Some modules integrate several systems of different size with the
+	 * same equation object, the stages are zeroed to keep the components
+	 * not touched by the function out of the error estimation.
+	 */
+	for (i = 0; i < n; i++) {
+		y[i] = equation->initial_vector[i];
+		k1[i] = k2[i] = k3[i] = k4[i] = k5[i] = k6[i] = k7[i] = 0;
+	}
+
+	t = start;
+	h = (step > 0 && step < end - start) ? step : end - start;
+	h_min = 1e-12 * fmax(1.0, fabs(end));
+
+	equation->function(cat, t, y, k1);
+
+	while (end - t > h_min) {
+		if (t + h > end)
+			h = end - t;
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * DP_A21 * k1[i];
+		equation->function(cat, t + DP_C2 * h, y1, k2);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (DP_A31 * k1[i] + DP_A32 * k2[i]);
+		equation->function(cat, t + DP_C3 * h, y1, k3);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (DP_A41 * k1[i] + DP_A42 * k2[i] +
+					DP_A43 * k3[i]);
+		equation->function(cat, t + DP_C4 * h, y1, k4);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (DP_A51 * k1[i] + DP_A52 * k2[i] +
+					DP_A53 * k3[i] + DP_A54 * k4[i]);
+		equation->function(cat, t + DP_C5 * h, y1, k5);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (DP_A61 * k1[i] + DP_A62 * k2[i] +
+					DP_A63 * k3[i] + DP_A64 * k4[i] +
+					DP_A65 * k5[i]);
+		equation->function(cat, t + h, y1, k6);
+
+		for (i = 0; i < n; i++)
+			y5[i] = y[i] + h * (DP_B1 * k1[i] + DP_B3 * k3[i] +
+					DP_B4 * k4[i] + DP_B5 * k5[i] +
+					DP_B6 * k6[i]);
+		equation->function(cat, t + h, y5, k7);
+
+		/* Root mean square of the error scaled by the tolerance */
+		err = 0.0;
+		for (i = 0; i < n; i++) {
+			e = h * (DP_E1 * k1[i] + DP_E3 * k3[i] +
+				 DP_E4 * k4[i] + DP_E5 * k5[i] +
+				 DP_E6 * k6[i] + DP_E7 * k7[i]);
+			sc = abs_tol + rel_tol * fmax(fabs(y[i]), fabs(y5[i]));
+			err += (e / sc) * (e / sc);
+		}
+		err = sqrt(err / n);
+
+		if (err <= 1.0) {
+			for (; d < num_dense && (dense_t[d] <= t + h ||
+					end - (t + h) <= h_min); d++) {
+				dp_dense_weights(fmin(1.0,
+						(dense_t[d] - t) / h),
+						&w1, &w3, &w4, &w5, &w6, &w7);
+				for (i = 0; i < n; i++)
+					dense_vector[d][i] = y[i] + h *
+						(w1 * k1[i] + w3 * k3[i] +
+						 w4 * k4[i] + w5 * k5[i] +
+						 w6 * k6[i] + w7 * k7[i]);
+			}
+
+			t += h;
+			for (i = 0; i < n; i++) {
+				y[i] = y5[i];
+				k1[i] = k7[i];
+			}
+			accepted++;
+
+			factor = (err > 0.0) ?
+				DP_SAFETY * pow(err, -0.2) : DP_MAX_FACTOR;
+			factor = fmin(DP_MAX_FACTOR,
+					fmax(DP_MIN_FACTOR, factor));
+		} else {
+			rejected++;
+
+			factor = fmax(DP_MIN_FACTOR, DP_SAFETY * pow(err, -0.2));
+		}
+
+		h *= factor;
+
+		if ((h < h_min && t + h_min < end) ||
+				accepted + rejected >=
+				CONFIG_INTEGRATION_MAX_STEPS) {
+			ret = -1;
+			break;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		equation->resulting_vector[i] = y[i];
+	}
+
+	if (num_saved)
+		*num_saved = d;
+
+	evaluations = 1 + 6 * (accepted + rejected);
+	INTEGRATION_STATS_ADD(&cat->stats, 1, accepted, rejected, evaluations);
+
+	if (stats) {
+		stats->integrations = 1;
+		stats->accepted     = accepted;
+		stats->rejected     = rejected;
+		stats->evaluations  = evaluations;
+	}
+
+	return ret;
+}
+
+/**
+ * dormand_prince_tol() - adaptive method for non-complex systems
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @abs_tol     absolute tolerance of the local error
+ * @rel_tol     relative tolerance of the local error
+ * @catastrophe pointer to a catastrophe descriptor
+ * @stats       work done by the call, may be NULL
+ *
+ * Returns 0 on success and -1 if the step size has collapsed or the limit of
+ * steps is reached, the resulting vector holds the last accepted values then.
+ */
+int dormand_prince_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats)
+{
+	return dormand_prince_dense(start, end, step, abs_tol, rel_tol,
+			cat, stats, NULL, 0, NULL, NULL);
+}
+
+/**
+ * dormand_prince() - adaptive method with the interface of runge_kutta()
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @catastrophe pointer to a catastrophe descriptor
+ *
+ * The tolerances of the job or the default ones from kernel/core/config.h
+ * are used, see catastrophe_abs_tol(). A failed integration cancels the
+ * job, the resulting vector must not be taken as the point then.
+ */
+void dormand_prince(const double start, const double end, const double step,
+		catastrophe_t *const cat)
+{
+	if (dormand_prince_tol(start, end, step, catastrophe_abs_tol(cat),
+				catastrophe_rel_tol(cat), cat, NULL)) {
+		WAVECAT_ERROR(-1);
+		catastrophe_cancel(cat, CANCEL_FAILED);
+	}
+}
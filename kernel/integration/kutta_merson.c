@@ -0,0 +1,159 @@
+/**
+ * kernel/integration/kutta_merson.c - implementation of the
+ * Kutta-Merson method with automatic step size control to integrate systems
+ * of ordinary differential equations (ODE).
+ *
+ * NOTES:
+ *
+ * The method takes five evaluations of the function per step, the 4th order
+ * solution and the estimation of its local error are combined from the same
+ * stages. The step is halved while the error exceeds the tolerance and is
+ * doubled when the error is 32 times below it, so the steps stay the binary
+ * fractions of the initial one.
+ */
+
+#include <kernel/integration/kutta_merson.h>
+
+#include <math.h>
+
+/**
+ * kutta_merson_tol() - adaptive method for non-complex systems
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @abs_tol     absolute tolerance of the local error
+ * @rel_tol     relative tolerance of the local error
+ * @catastrophe pointer to a catastrophe descriptor
+ * @stats       work done by the call, may be NULL
+ *
+ * Returns 0 on success and -1 if the step size has collapsed or the limit of
+ * steps is reached, the resulting vector holds the last accepted values then.
+ */
+int kutta_merson_tol(const double start, const double end,
+		const double step, const double abs_tol, const double rel_tol,
+		catastrophe_t *const cat, integration_stats_t *stats)
+{
+	equation_t *equation;
+
+	double k1[CONFIG_CAT_MAX_EQUATIONS];
+	double k2[CONFIG_CAT_MAX_EQUATIONS];
+	double k3[CONFIG_CAT_MAX_EQUATIONS];
+	double k4[CONFIG_CAT_MAX_EQUATIONS];
+	double k5[CONFIG_CAT_MAX_EQUATIONS];
+	double  y[CONFIG_CAT_MAX_EQUATIONS];
+	double y1[CONFIG_CAT_MAX_EQUATIONS];
+	double y4[CONFIG_CAT_MAX_EQUATIONS];
+
+	double t, h, h_min, err, sc, e;
+	unsigned long accepted = 0, rejected = 0, evaluations;
+	unsigned int i, n;
+	int ret = 0;
+
+	equation = cat->equation;
+	n = equation->num_equations;
+
+	/* The same as in dormand_prince_dense() */
+	for (i = 0; i < n; i++) {
+		y[i] = equation->initial_vector[i];
+		k1[i] = k2[i] = k3[i] = k4[i] = k5[i] = 0;
+	}
+
+	t = start;
+	h = (step > 0 && step < end - start) ? step : end - start;
+	h_min = 1e-12 * fmax(1.0, fabs(end));
+
+	while (end - t > h_min) {
+		if (t + h > end)
+			h = end - t;
+
+		equation->function(cat, t, y, k1);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * k1[i] / 3.0;
+		equation->function(cat, t + h / 3.0, y1, k2);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (k1[i] + k2[i]) / 6.0;
+		equation->function(cat, t + h / 3.0, y1, k3);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (k1[i] + 3.0 * k3[i]) / 8.0;
+		equation->function(cat, t + h / 2.0, y1, k4);
+
+		for (i = 0; i < n; i++)
+			y1[i] = y[i] + h * (k1[i] - 3.0 * k3[i] + 4.0 * k4[i]) /
+				2.0;
+		equation->function(cat, t + h, y1, k5);
+
+		/* Root mean square of the error scaled by the tolerance */
+		err = 0.0;
+		for (i = 0; i < n; i++) {
+			y4[i] = y[i] + h * (k1[i] + 4.0 * k4[i] + k5[i]) / 6.0;
+			e = fabs(h * (2.0 * k1[i] - 9.0 * k3[i] + 8.0 * k4[i] -
+					k5[i]) / 30.0);
+			sc = abs_tol + rel_tol * fmax(fabs(y[i]), fabs(y4[i]));
+			err += (e / sc) * (e / sc);
+		}
+		err = sqrt(err / n);
+
+		if (err <= 1.0) {
+			t += h;
+			for (i = 0; i < n; i++)
+				y[i] = y4[i];
+			accepted++;
+
+			if (err <= 1.0 / 32.0)
+				h *= 2.0;
+		} else {
+			rejected++;
+
+			h /= 2.0;
+		}
+
+		if ((h < h_min && t + h_min < end) ||
+				accepted + rejected >=
+				CONFIG_INTEGRATION_MAX_STEPS) {
+			ret = -1;
+			break;
+		}
+	}
+
+	for (i = 0; i < n; i++) {
+		equation->resulting_vector[i] = y[i];
+	}
+
+	evaluations = 5 * (accepted + rejected);
+	INTEGRATION_STATS_ADD(&cat->stats, 1, accepted, rejected, evaluations);
+
+	if (stats) {
+		stats->integrations = 1;
+		stats->accepted     = accepted;
+		stats->rejected     = rejected;
+		stats->evaluations  = evaluations;
+	}
+
+	return ret;
+}
+
+/**
+ * kutta_merson() - adaptive method with the interface of
+ * runge_kutta()
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        initial step
+ * @catastrophe pointer to a catastrophe descriptor
+ *
+ * The tolerances of the job or the default ones from kernel/core/config.h
+ * are used, see catastrophe_abs_tol(). A failed integration cancels the
+ * job, the resulting vector must not be taken as the point then.
+ */
+void kutta_merson(const double start, const double end,
+		const double step, catastrophe_t *const cat)
+{
+	if (kutta_merson_tol(start, end, step,
+				catastrophe_abs_tol(cat),
+				catastrophe_rel_tol(cat), cat, NULL)) {
+		WAVECAT_ERROR(-1);
+		catastrophe_cancel(cat, CANCEL_FAILED);
+	}
+}
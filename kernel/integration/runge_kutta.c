@@ -35,6 +35,7 @@ void runge_kutta(const double start, const double end, const double step,
 	double y1[CONFIG_CAT_MAX_EQUATIONS];
 
 	double t, cur_t;
+	unsigned long steps = 0;
 	unsigned int i;
 
 	equation = cat->equation;
@@ -74,9 +75,12 @@ void runge_kutta(const double start, const double end, const double step,
 		}
 
 		t += step;
+		steps++;
 	}
 
 	for (i = 0; i < equation->num_equations; i++) {
 		equation->resulting_vector[i] = y[i];
 	}
+
+	INTEGRATION_STATS_ADD(&cat->stats, 1, steps, 0, 4 * steps);
 }
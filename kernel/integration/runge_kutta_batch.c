@@ -0,0 +1,88 @@
+/**
+ * kernel/integration/runge_kutta_batch.c - implementation of the classical
+ * Runge-Kutta method for CONFIG_BATCH_WIDTH points integrated at once.
+ *
+ * NOTES:
+ *
+ * The steps and the order of the operations are the same as in
+ * runge_kutta(), so every point of the batch gets the result of the scalar
+ * method. The innermost loops run over the points of the batch, they are
+ * contiguous in memory and are vectorized by the compiler.
+ */
+
+#include <kernel/integration/runge_kutta_batch.h>
+
+#define W CONFIG_BATCH_WIDTH
+
+/**
+ * runge_kutta_batch() - classical method for a batch of non-complex systems
+ * @start       start value of the t variable
+ * @end         second value of the t variable
+ * @step        step
+ * @function    batch function of the system
+ * @num_equations number of the equations of the system
+ * @p           parameters of the points of the batch
+ * @y           initial vectors, replaced by the resulting ones
+ *
+ * Returns the number of steps taken by every point of the batch.
+ */
+unsigned long runge_kutta_batch(const double start, const double end,
+		const double step, equation_batch_function_t function,
+		const unsigned int num_equations,
+		const double (*p)[CONFIG_BATCH_WIDTH],
+		double (*y)[CONFIG_BATCH_WIDTH])
+{
+	double k1[CONFIG_CAT_MAX_EQUATIONS][W] __attribute__ ((aligned (64)));
+	double k2[CONFIG_CAT_MAX_EQUATIONS][W] __attribute__ ((aligned (64)));
+	double k3[CONFIG_CAT_MAX_EQUATIONS][W] __attribute__ ((aligned (64)));
+	double k4[CONFIG_CAT_MAX_EQUATIONS][W] __attribute__ ((aligned (64)));
+	double y1[CONFIG_CAT_MAX_EQUATIONS][W] __attribute__ ((aligned (64)));
+
+	double t, cur_t;
+	unsigned long steps = 0;
+	unsigned int i, w;
+
+	t = start;
+
+	while (t < end - step) {
+		cur_t = t;
+		function(cur_t, p, (const double (*)[W]) y, k1);
+		for (i = 0; i < num_equations; i++) {
+			for (w = 0; w < W; w++) {
+				k1[i][w] = k1[i][w] * step;
+				y1[i][w] = y[i][w] + k1[i][w] / 2.0;
+			}
+		}
+		cur_t = t + step / 2.0;
+		function(cur_t, p, (const double (*)[W]) y1, k2);
+		for (i = 0; i < num_equations; i++) {
+			for (w = 0; w < W; w++) {
+				k2[i][w] = k2[i][w] * step;
+				y1[i][w] = y[i][w] + k2[i][w] / 2.0;
+			}
+		}
+		cur_t = t + step / 2.0;
+		function(cur_t, p, (const double (*)[W]) y1, k3);
+		for (i = 0; i < num_equations; i++) {
+			for (w = 0; w < W; w++) {
+				k3[i][w] = k3[i][w] * step;
+				y1[i][w] = y[i][w] + k3[i][w];
+			}
+		}
+		cur_t = t + step;
+		function(cur_t, p, (const double (*)[W]) y1, k4);
+		for (i = 0; i < num_equations; i++) {
+			for (w = 0; w < W; w++) {
+				k4[i][w] = k4[i][w] * step;
+				y[i][w] = y[i][w] +
+					(k1[i][w] + 2.0 * k2[i][w] +
+					 2.0 * k3[i][w] + k4[i][w]) / 6.0;
+			}
+		}
+
+		t += step;
+		steps++;
+	}
+
+	return steps;
+}
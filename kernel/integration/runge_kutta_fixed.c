@@ -0,0 +1,70 @@
+/**
+ * kernel/integration/runge_kutta_fixed.c - the classical Runge-Kutta method
+ * specialized for the sizes of the systems used by the catastrophes.
+ *
+ * NOTES:
+ *
+ * The methods call the function of the equation indirectly, they are used
+ * for the descriptors without their own stepper.
+ */
+
+#include <kernel/integration/runge_kutta.h>
+#include <kernel/integration/cmplx_runge_kutta.h>
+#include <kernel/integration/runge_kutta_fixed.h>
+
+#include <complex.h>
+
+#define RUNGE_KUTTA_N(n)						\
+	RUNGE_KUTTA_FIXED_DEFINE(static, runge_kutta_##n, equation_t,	\
+			double, n, equation->function)			\
+	RUNGE_KUTTA_FIXED_DEFINE(static, cmplx_runge_kutta_##n,	\
+			cmplx_equation_t, double complex, n,		\
+			equation->function)
+
+RUNGE_KUTTA_N(1)
+RUNGE_KUTTA_N(2)
+RUNGE_KUTTA_N(3)
+RUNGE_KUTTA_N(4)
+RUNGE_KUTTA_N(6)
+RUNGE_KUTTA_N(8)
+
+/**
+ * runge_kutta_fixed() - select the method for the real system size
+ * @num_equations number of the equations of the system
+ *
+ * Returns the specialized method or runge_kutta() for other sizes.
+ */
+catastrophe_integrate_t runge_kutta_fixed(const unsigned int num_equations)
+{
+	switch (num_equations) {
+	case 1: return runge_kutta_1;
+	case 2: return runge_kutta_2;
+	case 3: return runge_kutta_3;
+	case 4: return runge_kutta_4;
+	case 6: return runge_kutta_6;
+	case 8: return runge_kutta_8;
+	}
+
+	return runge_kutta;
+}
+
+/**
+ * cmplx_runge_kutta_fixed() - select the method for the complex system size
+ * @num_equations number of the equations of the system
+ *
+ * Returns the specialized method or cmplx_runge_kutta() for other sizes.
+ */
+catastrophe_integrate_t cmplx_runge_kutta_fixed(
+		const unsigned int num_equations)
+{
+	switch (num_equations) {
+	case 1: return cmplx_runge_kutta_1;
+	case 2: return cmplx_runge_kutta_2;
+	case 3: return cmplx_runge_kutta_3;
+	case 4: return cmplx_runge_kutta_4;
+	case 6: return cmplx_runge_kutta_6;
+	case 8: return cmplx_runge_kutta_8;
+	}
+
+	return cmplx_runge_kutta;
+}
@@ -1,5 +1,6 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <math.h>
 
 #include <kernel/core/config.h>
 #include <kernel/core/catastrophe.h>
@@ -57,7 +58,15 @@ enum jsi_parse_state {
 	PARSE_PAR_ARR_1,
 	PARSE_PAR_ARR_2,
 	PARSE_MODE,
-	PARSE_DERIV
+	PARSE_DERIV,
+	PARSE_SWEEP,
+	PARSE_METHOD,
+	PARSE_TOL,
+	PARSE_QUALITY,
+	PARSE_THREADS,
+	PARSE_TIMEOUT,
+	PARSE_DETERMINISTIC,
+	PARSE_LATTICE
 };
 
 static char *state_str[] = {
@@ -69,7 +78,15 @@ static char *state_str[] = {
 	"PARSE_PAR_ARR_1",
 	"PARSE_PAR_ARR_2",
 	"PARSE_MODE",
-	"PARSE_DERIV"
+	"PARSE_DERIV",
+	"PARSE_SWEEP",
+	"PARSE_METHOD",
+	"PARSE_TOL",
+	"PARSE_QUALITY",
+	"PARSE_THREADS",
+	"PARSE_TIMEOUT",
+	"PARSE_DETERMINISTIC",
+	"PARSE_LATTICE"
 };
 
 struct jsi_parse_cont {
@@ -78,6 +95,13 @@ struct jsi_parse_cont {
 	char              name[MAX_NAME_LEN];
 	int               is_phase;
 	unsigned int      deriv;
+	catastrophe_sweep_t sweep;
+	catastrophe_method_t method;
+	double            tol;
+	unsigned int      threads;
+	double            timeout;
+	int               deterministic;
+	int               lattice;
 
 	enum jsi_parse_state state;
 };
@@ -91,6 +115,13 @@ static inline int jsi_parse_cont_init(struct jsi_parse_cont *jpc)
 	jpc->is_phase    = 0;
 	jpc->state       = PARSE_TOP_KEY;
 	jpc->deriv       = 0;
+	jpc->sweep       = SWEEP_POINT;
+	jpc->method      = METHOD_DEFAULT;
+	jpc->tol         = 0;
+	jpc->threads     = 0;
+	jpc->timeout     = 0;
+	jpc->deterministic = 0;
+	jpc->lattice     = 0;
 
 	return 0;
 }
@@ -191,6 +222,44 @@ jsi_parse_str( struct jsi_parse_cont *jpc,
 	else if (jpc->state == PARSE_MODE) {
 		if (0 == strcmp(temp, "phase"))
 			jpc->is_phase = 1;
+	} else if (jpc->state == PARSE_SWEEP) {
+		if (0 == strcmp(temp, "ray"))
+			jpc->sweep = SWEEP_RAY;
+		else if (0 == strcmp(temp, "continuation"))
+			jpc->sweep = SWEEP_CONTINUATION;
+		else if (0 == strcmp(temp, "point"))
+			jpc->sweep = SWEEP_POINT;
+		else {
+			err = -1;
+			fprintf(stderr, "Unknown sweep: %s\n", temp);
+			CGI_ERROR("Unknown sweep");
+		}
+	} else if (jpc->state == PARSE_METHOD) {
+		if (0 == strcmp(temp, "rk4"))
+			jpc->method = METHOD_RK4;
+		else if (0 == strcmp(temp, "magnus"))
+			jpc->method = METHOD_MAGNUS;
+		else if (0 == strcmp(temp, "gbs"))
+			jpc->method = METHOD_GBS;
+		else if (0 == strcmp(temp, "kutta-merson"))
+			jpc->method = METHOD_KUTTA_MERSON;
+		else {
+			err = -1;
+			fprintf(stderr, "Unknown method: %s\n", temp);
+			CGI_ERROR("Unknown method");
+		}
+	} else if (jpc->state == PARSE_QUALITY) {
+		if (0 == strcmp(temp, "preview"))
+			jpc->tol = CONFIG_QUALITY_PREVIEW_TOL;
+		else if (0 == strcmp(temp, "normal"))
+			jpc->tol = CONFIG_QUALITY_NORMAL_TOL;
+		else if (0 == strcmp(temp, "high"))
+			jpc->tol = CONFIG_QUALITY_HIGH_TOL;
+		else {
+			err = -1;
+			fprintf(stderr, "Unknown quality: %s\n", temp);
+			CGI_ERROR("Unknown quality");
+		}
 	} else {
 		err = -1;
 		fprintf(stderr, "Incorrect state (string)\n");
@@ -229,6 +298,22 @@ jsi_parse_prim( struct jsi_parse_cont *jpc,
 				jpc->state = PARSE_MODE;
 			} else if (0 == strcmp(temp, "deriv")) {
 				jpc->state = PARSE_DERIV;
+			} else if (0 == strcmp(temp, "sweep")) {
+				jpc->state = PARSE_SWEEP;
+			} else if (0 == strcmp(temp, "method")) {
+				jpc->state = PARSE_METHOD;
+			} else if (0 == strcmp(temp, "tol")) {
+				jpc->state = PARSE_TOL;
+			} else if (0 == strcmp(temp, "quality")) {
+				jpc->state = PARSE_QUALITY;
+			} else if (0 == strcmp(temp, "threads")) {
+				jpc->state = PARSE_THREADS;
+			} else if (0 == strcmp(temp, "timeout")) {
+				jpc->state = PARSE_TIMEOUT;
+			} else if (0 == strcmp(temp, "deterministic")) {
+				jpc->state = PARSE_DETERMINISTIC;
+			} else if (0 == strcmp(temp, "lattice")) {
+				jpc->state = PARSE_LATTICE;
 			} else {
 				err = -1;
 				fprintf(stderr, "Incorrect top key\n");
@@ -272,6 +357,62 @@ jsi_parse_prim( struct jsi_parse_cont *jpc,
 			jpc->deriv = atoi(temp);
 			jpc->state = PARSE_TOP_KEY;
 			break;
+		case PARSE_TOL:
+			jpc->tol = atof(temp);
+			if (jpc->tol <= 0) {
+				err = -1;
+				fprintf(stderr, "Incorrect tolerance\n");
+				CGI_ERROR("Tolerance must be positive");
+				goto out;
+			}
+			jpc->state = PARSE_TOP_KEY;
+			break;
+		case PARSE_THREADS:
+			if (atoi(temp) <= 0) {
+				err = -1;
+				fprintf(stderr, "Incorrect number of threads\n");
+				CGI_ERROR("Number of threads must be positive");
+				goto out;
+			}
+			jpc->threads = atoi(temp);
+			jpc->state = PARSE_TOP_KEY;
+			break;
+		case PARSE_TIMEOUT:
+			jpc->timeout = atof(temp);
+			if (jpc->timeout <= 0) {
+				err = -1;
+				fprintf(stderr, "Incorrect timeout\n");
+				CGI_ERROR("Timeout must be positive");
+				goto out;
+			}
+			jpc->state = PARSE_TOP_KEY;
+			break;
+		case PARSE_DETERMINISTIC:
+			if (0 == strcmp(temp, "true")) {
+				jpc->deterministic = 1;
+			} else if (0 == strcmp(temp, "false")) {
+				jpc->deterministic = 0;
+			} else {
+				err = -1;
+				fprintf(stderr, "Incorrect deterministic\n");
+				CGI_ERROR("Deterministic must be a boolean");
+				goto out;
+			}
+			jpc->state = PARSE_TOP_KEY;
+			break;
+		case PARSE_LATTICE:
+			if (0 == strcmp(temp, "true")) {
+				jpc->lattice = 1;
+			} else if (0 == strcmp(temp, "false")) {
+				jpc->lattice = 0;
+			} else {
+				err = -1;
+				fprintf(stderr, "Incorrect lattice\n");
+				CGI_ERROR("Lattice must be a boolean");
+				goto out;
+			}
+			jpc->state = PARSE_TOP_KEY;
+			break;
 		default:
 			err = -1;
 			fprintf(stderr, "Incorrect state (primitive)\n");
@@ -376,16 +517,96 @@ is_deriv_correct(catastrophe_desc_t *desc, unsigned int deriv)
 		(deriv < desc->num_equations);
 }
 
+/*
+ * jsi_snap_lattice() - move the axes of the job onto the dyadic lattice,
+ * the requested values are kept in @requested.
+ */
+static int
+jsi_snap_lattice( struct jsi_parse_cont *jpc,
+		  parameter_t *requested,
+		  int *level )
+{
+	unsigned int i;
+
+	memcpy(requested, jpc->parameter,
+			jpc->param_index * sizeof(*requested));
+
+	for (i = 0; i < jpc->param_index; i++) {
+		if (!jpc->parameter[i].num_steps ||
+		    jpc->parameter[i].min_value ==
+		    jpc->parameter[i].max_value)
+			continue;
+
+		if (catastrophe_snap_lattice(&jpc->parameter[i], &level[i])) {
+			fprintf(stderr, "Cannot snap the grid\n");
+			CGI_ERROR("Grid is out of the lattice");
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+/*
+ * jsi_print_lattice() - print the levels of the snapped axes, their numbers
+ * of the steps and the shifts of their ends. The error is the largest shift relative to the requested
+ * range of its axis.
+ */
+static void
+jsi_print_lattice( struct jsi_parse_cont *jpc,
+		   parameter_t *requested,
+		   int *level )
+{
+	double min_shift, max_shift, range, error = 0;
+	unsigned int i, num = 0;
+
+	fprintf(out_file_desc, "\nexperimentLattice = {\n");
+	fprintf(out_file_desc, "axes : [");
+
+	for (i = 0; i < jpc->param_index; i++) {
+		if (!requested[i].num_steps ||
+		    requested[i].min_value == requested[i].max_value)
+			continue;
+
+		min_shift = jpc->parameter[i].min_value -
+			requested[i].min_value;
+		max_shift = jpc->parameter[i].max_value -
+			requested[i].max_value;
+		range = fabs(requested[i].max_value - requested[i].min_value);
+
+		if (fabs(min_shift) / range > error)
+			error = fabs(min_shift) / range;
+		if (fabs(max_shift) / range > error)
+			error = fabs(max_shift) / range;
+
+		fprintf(out_file_desc, "%s{name : \"%s\", level : %d, "
+				"step : %g, steps : %u, minShift : %g, "
+				"maxShift : %g}",
+				num++ ? ", " : "", requested[i].sym_name,
+				level[i], ldexp(1.0, -level[i]),
+				jpc->parameter[i].num_steps,
+				min_shift, max_shift);
+	}
+
+	fprintf(out_file_desc, "],\n");
+	fprintf(out_file_desc, "error : %g\n", error);
+	fprintf(out_file_desc, "};");
+}
+
 int json_input(const char *json_str)
 {
 	jsmn_parser parser;
 
 	struct jsi_parse_cont jpc;
+	parameter_t requested[MAX_PARAMETERS];
+	int level[MAX_PARAMETERS];
 
 	catastrophe_desc_t       *catastrophe_desc = NULL;
 	catastrophe_t *catastrophe;
+	cancel_token_t cancel;
 
-#define NRTOKENS  50
+/* Five tokens a parameter of the largest catastrophe and two a key */
+#define NRTOKENS  128
 	jsmntok_t tokens[NRTOKENS];
 	int ret;
 
@@ -424,6 +645,13 @@ int json_input(const char *json_str)
 		return -1;
 	}
 
+	/* The ray and the continuation integrate by Dormand-Prince */
+	if (jpc.sweep != SWEEP_POINT && jpc.method != METHOD_DEFAULT) {
+		fprintf(stderr, "Method cannot be chosen for the sweep\n");
+		CGI_ERROR("Method cannot be chosen for the sweep");
+		return -1;
+	}
+
 	catastrophe_desc = find_catastrophe_desc(jpc.name);
 
 	if (catastrophe_desc) {
@@ -438,21 +666,52 @@ int json_input(const char *json_str)
 			CGI_ERROR("Incorrect derivative number");
 			return -1;
 		}
+		if (jpc.lattice && jsi_snap_lattice(&jpc, requested, level))
+			return -1;
 		catastrophe = catastrophe_desc->fabric(catastrophe_desc,
 				jpc.parameter, jpc.deriv);
 		if (!catastrophe)
 			return -1;
+		catastrophe->sweep = jpc.sweep;
+		catastrophe->tol   = jpc.tol;
+		catastrophe->num_threads = jpc.threads;
+		catastrophe->deterministic = jpc.deterministic;
+		cancel_token_init(&cancel, cgi_client_fd, jpc.timeout);
+		catastrophe->cancel = &cancel;
+		if (catastrophe_set_method(catastrophe, jpc.method)) {
+			fprintf(stderr, "Method is not applicable\n");
+			CGI_ERROR("Method is not applicable");
+			destruct_catastrophe(catastrophe);
+			return -1;
+		}
 		if (catastrophe_parallel_loop(catastrophe)) {
-			CGI_ERROR("Error during computing");
+			switch (cancel_token_reason(&cancel)) {
+			case CANCEL_DEADLINE:
+				fprintf(stderr, "Timeout of the job is over\n");
+				CGI_ERROR("Timeout is over");
+				break;
+			case CANCEL_DISCONNECT:
+				fprintf(stderr, "Client has closed the "
+						"connection\n");
+				break;
+			default:
+				CGI_ERROR("Error during computing");
+			}
 			destruct_catastrophe(catastrophe);
 			return -1;
 		}
+		catastrophe_account_stats(catastrophe);
 		if (!jpc.is_phase)
 			point_array_module_print_json(
 				catastrophe->point_array);
 		else
 			point_array_phase_print_json(
 				catastrophe->point_array);
+		if (jpc.deterministic)
+			point_array_digest_print_json(
+				catastrophe->point_array, CONFIG_TILE_SIZE);
+		if (jpc.lattice)
+			jsi_print_lattice(&jpc, requested, level);
 		destruct_catastrophe(catastrophe);
 	}  else {
 		fprintf(stderr, "Corresponding module is not found\n");
@@ -0,0 +1,755 @@
+/**
+ * kernel/net/distributed.c - computation of the grid by worker processes.
+ *
+ * NOTES:
+ *
+ * A worker is a wavecat process started with "--worker ADDRESS", it serves
+ * the tiles requested on the TCP ("host:port") or Unix ("unix:/path")
+ * socket one by one and computes each of them with its own thread pool. A
+ * coordinator silent for DIST_IO_TIMEOUT_S is dropped.
+ *
+ * The coordinator is a wavecat process started with "--workers LIST", it
+ * connects to the workers for every job, cuts the grid into the tiles of
+ * CONFIG_DIST_TILE_SIZE points a side and keeps every worker busy with a
+ * tile at a time. The points of the answers are written straight into the
+ * grid of the job.
+ *
+ * The tile of a failed worker is sent to another one. A tile late by
+ * CONFIG_DIST_SLOW_FACTOR times the mean time of a tile is sent to an idle
+ * worker once more, the first answer is taken and the other one is dropped.
+ * The job is computed by the local threads if no worker is reachable.
+ */
+
+#define _GNU_SOURCE
+
+#include <kernel/net/distributed.h>
+#include <kernel/core/catastrophe_parallel.h>
+#include <kernel/core/cancel.h>
+
+#include <sys/types.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <netdb.h>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+
+/* A worker not answering for that long is treated as failed */
+#define DIST_IO_TIMEOUT_S 30
+/* A worker not accepting the connection for that long is not reachable */
+#define DIST_CONNECT_TIMEOUT_MS 3000
+
+enum dist_tile_state_e {
+	TILE_PENDING = 0,
+	TILE_SENT,
+	TILE_DONE,
+};
+
+struct dist_tile {
+	unsigned int first_x;
+	unsigned int num_x;
+	unsigned int first_y;
+	unsigned int num_y;
+	enum dist_tile_state_e state;
+	/* Workers computing the tile at the moment */
+	unsigned int copies;
+	/* Time the tile was sent first */
+	long         sent_ms;
+};
+
+struct dist_worker {
+	const char  *address;
+	int          fd;
+	/* Tile being computed, -1 if the worker is idle */
+	int          tile;
+	long         sent_ms;
+};
+
+static char *dist_addresses[CONFIG_DIST_MAX_WORKERS];
+static unsigned int dist_num_addresses;
+/* The loop of the job when no worker is reachable */
+static catastrophe_parallel_func_t dist_local_loop;
+
+static long dist_now_ms(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return now.tv_sec * 1000 + now.tv_nsec / 1000000;
+}
+
+static int dist_write_full(int fd, const void *buf, size_t len)
+{
+	const char *p = buf;
+	ssize_t ret;
+
+	while (len) {
+		ret = send(fd, p, len, MSG_NOSIGNAL);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return -1;
+		p += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+static int dist_read_full(int fd, void *buf, size_t len)
+{
+	char *p = buf;
+	ssize_t ret;
+
+	while (len) {
+		ret = recv(fd, p, len, 0);
+		if (ret < 0 && errno == EINTR)
+			continue;
+		if (ret <= 0)
+			return -1;
+		p += ret;
+		len -= ret;
+	}
+
+	return 0;
+}
+
+/*
+ * dist_connect() - connect the socket within DIST_CONNECT_TIMEOUT_MS, so an
+ * unreachable host does not hold the job for the timeout of the kernel.
+ * Returns 0 on success and -1 otherwise.
+ */
+static int dist_connect(int fd, const struct sockaddr *addr, socklen_t len)
+{
+	struct pollfd pfd;
+	socklen_t err_len = sizeof(int);
+	int flags, err = 0, ret;
+
+	flags = fcntl(fd, F_GETFL);
+	if (flags == -1 || fcntl(fd, F_SETFL, flags | O_NONBLOCK))
+		return -1;
+
+	if (connect(fd, addr, len)) {
+		if (errno != EINPROGRESS)
+			return -1;
+
+		pfd.fd     = fd;
+		pfd.events = POLLOUT;
+		do {
+			ret = poll(&pfd, 1, DIST_CONNECT_TIMEOUT_MS);
+		} while (ret < 0 && errno == EINTR);
+
+		if (ret <= 0 ||
+		    getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &err_len) ||
+		    err)
+			return -1;
+	}
+
+	return fcntl(fd, F_SETFL, flags) ? -1 : 0;
+}
+
+/*
+ * dist_open() - open a socket of the address.
+ *
+ * The address is "unix:/path" or "host:port", the host may be empty for the
+ * listening socket of a worker. Returns the descriptor or -1.
+ */
+static int dist_open(const char *address, int is_server)
+{
+	struct addrinfo hints, *res, *ai;
+	struct sockaddr_un sun;
+	char host[256];
+	const char *port;
+	int fd = -1, one = 1;
+
+	if (0 == strncmp(address, "unix:", 5)) {
+		if (strlen(address + 5) >= sizeof(sun.sun_path))
+			return -1;
+
+		memset(&sun, 0, sizeof(sun));
+		sun.sun_family = AF_UNIX;
+		strcpy(sun.sun_path, address + 5);
+
+		fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		if (fd == -1)
+			return -1;
+
+		if (is_server) {
+			unlink(sun.sun_path);
+			if (!bind(fd, (struct sockaddr *) &sun, sizeof(sun)) &&
+					!listen(fd, 16))
+				return fd;
+		} else if (!dist_connect(fd, (struct sockaddr *) &sun,
+					sizeof(sun))) {
+			return fd;
+		}
+
+		close(fd);
+		return -1;
+	}
+
+	port = strrchr(address, ':');
+	if (!port || (size_t) (port - address) >= sizeof(host))
+		return -1;
+	memcpy(host, address, port - address);
+	host[port - address] = '\0';
+	port++;
+
+	memset(&hints, 0, sizeof(hints));
+	hints.ai_family   = AF_UNSPEC;
+	hints.ai_socktype = SOCK_STREAM;
+	hints.ai_flags    = is_server ? AI_PASSIVE : 0;
+
+	if (getaddrinfo(host[0] ? host : NULL, port, &hints, &res))
+		return -1;
+
+	for (ai = res; ai; ai = ai->ai_next) {
+		fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+		if (fd == -1)
+			continue;
+
+		if (is_server) {
+			setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one,
+					sizeof(one));
+			if (!bind(fd, ai->ai_addr, ai->ai_addrlen) &&
+					!listen(fd, 16))
+				break;
+		} else if (!dist_connect(fd, ai->ai_addr, ai->ai_addrlen)) {
+			setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one,
+					sizeof(one));
+			break;
+		}
+
+		close(fd);
+		fd = -1;
+	}
+
+	freeaddrinfo(res);
+	return fd;
+}
+
+/**
+ * distributed_set_workers() - compute the jobs by the worker processes
+ * @addresses comma separated addresses of the workers
+ *
+ * Returns 0 on success and -1 if the list is incorrect.
+ */
+int distributed_set_workers(const char *addresses)
+{
+	const char *p = addresses, *end;
+
+	while (*p) {
+		end = strchr(p, ',');
+		if (!end)
+			end = p + strlen(p);
+
+		if (end == p || dist_num_addresses == CONFIG_DIST_MAX_WORKERS)
+			return -1;
+
+		dist_addresses[dist_num_addresses] = strndup(p, end - p);
+		if (!dist_addresses[dist_num_addresses])
+			return -1;
+		dist_num_addresses++;
+
+		p = *end ? end + 1 : end;
+	}
+
+	if (!dist_num_addresses)
+		return -1;
+
+	if (catastrophe_parallel_loop != catastrophe_loop_distributed) {
+		dist_local_loop = catastrophe_parallel_loop;
+		catastrophe_parallel_loop = catastrophe_loop_distributed;
+	}
+
+	return 0;
+}
+
+static void dist_worker_fail(struct dist_worker *worker,
+		struct dist_tile *tiles)
+{
+	struct dist_tile *tile;
+
+	fprintf(stderr, "[distributed] Worker %s has failed.\n",
+			worker->address);
+
+	close(worker->fd);
+	worker->fd = -1;
+
+	if (worker->tile < 0)
+		return;
+
+	tile = &tiles[worker->tile];
+	tile->copies--;
+	if (tile->state == TILE_SENT && !tile->copies)
+		tile->state = TILE_PENDING;
+	worker->tile = -1;
+}
+
+/*
+ * The next tile for an idle worker: a pending one, or else a late one
+ * computed by a single worker. Returns -1 if there is no such tile.
+ */
+static int dist_next_tile(struct dist_tile *tiles, unsigned int num_tiles,
+		long now, long slow_ms)
+{
+	unsigned int i;
+	int late = -1;
+
+	for (i = 0; i < num_tiles; i++) {
+		if (tiles[i].state == TILE_PENDING)
+			return i;
+		if (late < 0 && tiles[i].state == TILE_SENT &&
+				tiles[i].copies == 1 &&
+				now - tiles[i].sent_ms > slow_ms)
+			late = i;
+	}
+
+	if (late >= 0)
+		fprintf(stderr, "[distributed] Tile %d is late, it is sent "
+				"once more.\n", late);
+
+	return late;
+}
+
+static int dist_send_tile(catastrophe_t *catastrophe, uint_pair_t *pair,
+		struct dist_worker *worker, struct dist_tile *tiles, int idx,
+		long now)
+{
+	struct dist_tile *tile = &tiles[idx];
+	struct dist_request req;
+	struct dist_param par[CONFIG_CAT_MAX_PARAMETERS];
+	parameter_t *p;
+	unsigned int i;
+
+	memset(&req, 0, sizeof(req));
+	req.magic          = DIST_MAGIC;
+	req.version        = DIST_VERSION;
+	req.tile           = idx;
+	req.num_parameters = catastrophe->num_parameters;
+	req.deriv          = catastrophe->deriv;
+	req.sweep          = catastrophe->sweep;
+	req.method         = catastrophe->method;
+	req.deterministic  = catastrophe->deterministic;
+	req.tol            = catastrophe->tol;
+	strncpy(req.name, catastrophe->sym_name, sizeof(req.name) - 1);
+
+	memset(par, 0, sizeof(par));
+	for (i = 0; i < catastrophe->num_parameters; i++) {
+		p = &catastrophe->parameter[i];
+		par[i].cur_value = p->cur_value;
+		par[i].min_value = p->min_value;
+		par[i].max_value = p->max_value;
+		par[i].step_size = p->step_size;
+		par[i].num_steps = p->num_steps;
+		memcpy(par[i].sym_name, p->sym_name, sizeof(par[i].sym_name));
+	}
+
+	/* The same as in parallel_tile_params() */
+	p = &catastrophe->parameter[pair->first];
+	par[pair->first].min_value = p->min_value + tile->first_x * p->step_size;
+	par[pair->first].max_value = par[pair->first].min_value +
+		tile->num_x * p->step_size;
+	par[pair->first].num_steps = tile->num_x;
+
+	p = &catastrophe->parameter[pair->second];
+	par[pair->second].min_value = p->min_value +
+		tile->first_y * p->step_size;
+	par[pair->second].max_value = par[pair->second].min_value +
+		tile->num_y * p->step_size;
+	par[pair->second].num_steps = tile->num_y;
+
+	if (dist_write_full(worker->fd, &req, sizeof(req)) ||
+			dist_write_full(worker->fd, par,
+				req.num_parameters * sizeof(*par)))
+		return -1;
+
+	if (tile->state == TILE_PENDING) {
+		tile->state = TILE_SENT;
+		tile->sent_ms = now;
+	}
+	tile->copies++;
+
+	worker->tile = idx;
+	worker->sent_ms = now;
+
+	return 0;
+}
+
+/*
+ * Receive the answer of a busy worker. Returns 0 on success, -1 if the
+ * worker has failed and 1 if the tile could not be computed.
+ */
+static int dist_receive_tile(catastrophe_t *catastrophe,
+		struct dist_worker *worker, struct dist_tile *tiles,
+		point_t *scratch, long *busy_ms)
+{
+	struct dist_response resp;
+	struct dist_tile *tile = &tiles[worker->tile];
+	point_array_t *pa = catastrophe->point_array;
+	integration_stats_t stats;
+	unsigned int i;
+
+	if (dist_read_full(worker->fd, &resp, sizeof(resp)) ||
+			resp.magic != DIST_MAGIC ||
+			resp.tile != (uint32_t) worker->tile)
+		return -1;
+
+	if (!resp.status) {
+		if (resp.num_x != tile->num_x || resp.num_y != tile->num_y)
+			return -1;
+		if (dist_read_full(worker->fd, scratch, sizeof(*scratch) *
+					tile->num_x * tile->num_y))
+			return -1;
+	}
+
+	tile->copies--;
+	worker->tile = -1;
+
+	/* The other copy of a late tile has already answered */
+	if (tile->state == TILE_DONE)
+		return 0;
+
+	if (resp.status)
+		return 1;
+
+	for (i = 0; i < tile->num_x; i++)
+		memcpy(pa->array[tile->first_x + i] + tile->first_y,
+				scratch + i * tile->num_y,
+				sizeof(*scratch) * tile->num_y);
+
+	stats.integrations = resp.integrations;
+	stats.accepted     = resp.accepted;
+	stats.rejected     = resp.rejected;
+	stats.evaluations  = resp.evaluations;
+	integration_stats_merge(&catastrophe->stats, &stats);
+
+	tile->state = TILE_DONE;
+	*busy_ms = dist_now_ms() - worker->sent_ms;
+
+	return 0;
+}
+
+/**
+ * catastrophe_loop_distributed() - compute the grid by the worker processes
+ * @catastrophe pointer to a catastrophe of the job
+ *
+ * Returns 0 on success and -1 if a tile could not be computed, the job is
+ * cancelled or all the workers have failed.
+ */
+int catastrophe_loop_distributed(catastrophe_t *catastrophe)
+{
+	struct dist_worker workers[CONFIG_DIST_MAX_WORKERS];
+	struct pollfd pfd[CONFIG_DIST_MAX_WORKERS];
+	struct dist_worker *busy[CONFIG_DIST_MAX_WORKERS];
+	struct dist_tile *tiles;
+	struct timeval timeout;
+	point_t *scratch;
+	uint_pair_t pair;
+
+	unsigned int tiles_x, tiles_y, num_tiles, num_done = 0, num_timed = 0;
+	unsigned int num_x, num_y, num_live, num_busy, i, x, y;
+	long now, slow_ms, total_ms = 0, busy_ms;
+	int is_failed = 0, idx, ret;
+
+	pair = catastrophe_search_alterable_params(catastrophe);
+	if (!catastrophe_is_pair_correct(&pair)) {
+		WAVECAT_ERROR(-1);
+		return -1;
+	}
+
+	timeout.tv_sec  = DIST_IO_TIMEOUT_S;
+	timeout.tv_usec = 0;
+
+	for (i = 0, num_live = 0; i < dist_num_addresses; i++) {
+		workers[i].address = dist_addresses[i];
+		workers[i].tile    = -1;
+		workers[i].fd      = dist_open(dist_addresses[i], 0);
+		if (workers[i].fd == -1) {
+			fprintf(stderr, "[distributed] Worker %s is not "
+					"reachable.\n", dist_addresses[i]);
+			continue;
+		}
+		setsockopt(workers[i].fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+				sizeof(timeout));
+		num_live++;
+	}
+
+	if (!num_live) {
+		fprintf(stderr, "[distributed] No worker is reachable, the job "
+				"is computed locally.\n");
+		return dist_local_loop(catastrophe);
+	}
+
+	catastrophe_prepare_params(catastrophe, pair.first, pair.second, 1);
+
+	fprintf(stderr, "Catastrophe %s calculation.\n",
+			catastrophe->sym_name);
+
+	num_x = catastrophe->parameter[pair.first].num_steps;
+	num_y = catastrophe->parameter[pair.second].num_steps;
+	tiles_x = (num_x + CONFIG_DIST_TILE_SIZE - 1) / CONFIG_DIST_TILE_SIZE;
+	tiles_y = (num_y + CONFIG_DIST_TILE_SIZE - 1) / CONFIG_DIST_TILE_SIZE;
+	num_tiles = tiles_x * tiles_y;
+
+	tiles = calloc(num_tiles, sizeof(*tiles));
+	scratch = malloc(sizeof(*scratch) *
+			CONFIG_DIST_TILE_SIZE * CONFIG_DIST_TILE_SIZE);
+	if (!tiles || !scratch) {
+		WAVECAT_ERROR(-ENOMEM);
+		is_failed = 1;
+		goto out;
+	}
+
+	for (x = 0, idx = 0; x < tiles_x; x++) {
+		for (y = 0; y < tiles_y; y++, idx++) {
+			tiles[idx].first_x = x * CONFIG_DIST_TILE_SIZE;
+			tiles[idx].num_x   = (x == tiles_x - 1) ?
+				num_x - tiles[idx].first_x :
+				CONFIG_DIST_TILE_SIZE;
+			tiles[idx].first_y = y * CONFIG_DIST_TILE_SIZE;
+			tiles[idx].num_y   = (y == tiles_y - 1) ?
+				num_y - tiles[idx].first_y :
+				CONFIG_DIST_TILE_SIZE;
+		}
+	}
+
+	fprintf(stderr, "[distributed] %u tiles of %ux%u points, %u "
+			"workers.\n", num_tiles, CONFIG_DIST_TILE_SIZE,
+			CONFIG_DIST_TILE_SIZE, num_live);
+
+	while (num_done < num_tiles) {
+		if (catastrophe_cancelled(catastrophe)) {
+			is_failed = 1;
+			break;
+		}
+
+		now = dist_now_ms();
+		slow_ms = num_timed ?
+			CONFIG_DIST_SLOW_FACTOR * total_ms / num_timed : 0;
+		if (slow_ms < CONFIG_DIST_SLOW_MIN_MS)
+			slow_ms = CONFIG_DIST_SLOW_MIN_MS;
+
+		/* Keep every worker busy */
+		for (i = 0; i < dist_num_addresses; i++) {
+			if (workers[i].fd == -1 || workers[i].tile >= 0)
+				continue;
+
+			idx = dist_next_tile(tiles, num_tiles, now, slow_ms);
+			if (idx < 0)
+				break;
+
+			if (dist_send_tile(catastrophe, &pair, &workers[i],
+						tiles, idx, now))
+				dist_worker_fail(&workers[i], tiles);
+		}
+
+		for (i = 0, num_live = 0, num_busy = 0;
+		     i < dist_num_addresses; i++) {
+			if (workers[i].fd == -1)
+				continue;
+			num_live++;
+			if (workers[i].tile < 0)
+				continue;
+			pfd[num_busy].fd      = workers[i].fd;
+			pfd[num_busy].events  = POLLIN;
+			pfd[num_busy].revents = 0;
+			busy[num_busy++] = &workers[i];
+		}
+
+		if (!num_live) {
+			fprintf(stderr, "[distributed] All the workers have "
+					"failed.\n");
+			CGI_ERROR("All the workers have failed");
+			is_failed = 1;
+			break;
+		}
+
+		/* Wake up regularly to check the token and the late tiles */
+		if (poll(pfd, num_busy, 100) < 0 && errno != EINTR) {
+			is_failed = 1;
+			break;
+		}
+
+		for (i = 0; i < num_busy; i++) {
+			if (!pfd[i].revents)
+				continue;
+
+			busy_ms = -1;
+			ret = dist_receive_tile(catastrophe, busy[i], tiles,
+					scratch, &busy_ms);
+			if (ret < 0) {
+				dist_worker_fail(busy[i], tiles);
+			} else if (ret > 0) {
+				catastrophe_cancel(catastrophe,
+						CANCEL_FAILED);
+				is_failed = 1;
+			} else if (busy_ms >= 0) {
+				total_ms += busy_ms;
+				num_timed++;
+				num_done++;
+			}
+		}
+
+		if (is_failed)
+			break;
+	}
+
+out:
+	for (i = 0; i < dist_num_addresses; i++)
+		if (workers[i].fd != -1)
+			close(workers[i].fd);
+
+	free(tiles);
+	free(scratch);
+
+	return is_failed ? -1 : 0;
+}
+
+/*
+ * Compute the tile of a request, the answer carries the points on success
+ * or the status only.
+ */
+static int dist_serve_tile(int fd)
+{
+	struct dist_request req;
+	struct dist_param par[CONFIG_CAT_MAX_PARAMETERS];
+	struct dist_response resp;
+	parameter_t parameter[CONFIG_CAT_MAX_PARAMETERS];
+	catastrophe_desc_t *desc;
+	catastrophe_t *cat = NULL;
+	cancel_token_t cancel;
+	unsigned int i, num_points = 0;
+	int err;
+
+	if (dist_read_full(fd, &req, sizeof(req)))
+		return -1;
+
+	if (req.magic != DIST_MAGIC || req.version != DIST_VERSION ||
+			req.num_parameters > CONFIG_CAT_MAX_PARAMETERS) {
+		fprintf(stderr, "[distributed] Incorrect request.\n");
+		return -1;
+	}
+
+	if (dist_read_full(fd, par, req.num_parameters * sizeof(*par)))
+		return -1;
+
+	memset(&resp, 0, sizeof(resp));
+	resp.magic  = DIST_MAGIC;
+	resp.tile   = req.tile;
+	resp.status = -1;
+
+	req.name[sizeof(req.name) - 1] = '\0';
+	memset(parameter, 0, sizeof(parameter));
+	for (i = 0; i < req.num_parameters; i++) {
+		parameter[i].cur_value = par[i].cur_value;
+		parameter[i].min_value = par[i].min_value;
+		parameter[i].max_value = par[i].max_value;
+		parameter[i].step_size = par[i].step_size;
+		parameter[i].num_steps = par[i].num_steps;
+		memcpy(parameter[i].sym_name, par[i].sym_name,
+				sizeof(parameter[i].sym_name));
+		parameter[i].sym_name[sizeof(parameter[i].sym_name) - 1] =
+			'\0';
+	}
+
+	desc = find_catastrophe_desc(req.name);
+	if (!desc || desc->num_parameters != req.num_parameters ||
+			req.deriv >= ((CT_REAL == desc->type) ?
+				desc->num_equations / 2 :
+				desc->num_equations)) {
+		fprintf(stderr, "[distributed] Incorrect job of %s.\n",
+				req.name);
+		goto answer;
+	}
+
+	cat = desc->fabric(desc, parameter, req.deriv);
+	if (!cat)
+		goto answer;
+
+	cat->sweep = req.sweep;
+	cat->tol   = req.tol;
+	cat->deterministic = req.deterministic;
+	if (catastrophe_set_method(cat, req.method))
+		goto answer;
+
+	/* The coordinator closes the connection when it drops the job */
+	cancel_token_init(&cancel, fd, 0);
+	cat->cancel = &cancel;
+
+	resp.status = catastrophe_parallel_loop(cat);
+	if (!resp.status) {
+		resp.num_x = cat->point_array->num_steps_x;
+		resp.num_y = cat->point_array->num_steps_y;
+		num_points = resp.num_x * resp.num_y;
+	}
+
+	resp.integrations = cat->stats.integrations;
+	resp.accepted     = cat->stats.accepted;
+	resp.rejected     = cat->stats.rejected;
+	resp.evaluations  = cat->stats.evaluations;
+
+answer:
+	err = dist_write_full(fd, &resp, sizeof(resp));
+	if (!err && num_points)
+		err = dist_write_full(fd, cat->point_array->points,
+				sizeof(point_t) * num_points);
+
+	destruct_catastrophe(cat);
+
+	return err;
+}
+
+/**
+ * distributed_worker() - serve the tiles of a coordinator
+ * @address address to listen on, "unix:/path" or "host:port"
+ *
+ * Returns only on an error of the listening socket.
+ */
+int distributed_worker(const char *address)
+{
+	struct timeval timeout;
+	int listen_fd, fd;
+
+	listen_fd = dist_open(address, 1);
+	if (listen_fd == -1) {
+		fprintf(stderr, "[distributed] Cannot listen on %s.\n",
+				address);
+		return 1;
+	}
+
+	fprintf(stderr, "[distributed] Worker is listening on %s.\n",
+			address);
+
+	for (;;) {
+		fd = accept(listen_fd, NULL, NULL);
+		if (fd == -1) {
+			if (errno == EINTR || errno == ECONNABORTED)
+				continue;
+			break;
+		}
+
+		/* An idle coordinator does not hold the worker for others */
+		timeout.tv_sec  = DIST_IO_TIMEOUT_S;
+		timeout.tv_usec = 0;
+		setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout,
+				sizeof(timeout));
+		setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout,
+				sizeof(timeout));
+
+		while (!dist_serve_tile(fd))
+			;
+
+		close(fd);
+	}
+
+	close(listen_fd);
+	return 1;
+}
@@ -1,7 +1,11 @@
 #include <kernel/core/catastrophe.h>
 #include <kernel/core/catastrophe_parallel.h>
+#include <kernel/core/thread_pool.h>
 #include <kernel/core/profiling.h>
+#include <kernel/cache/simple.h>
+#include <kernel/cache/file.h>
 #include <kernel/interface/command_line.h>
+#include <kernel/net/distributed.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -14,9 +18,14 @@ int plugin_loaddir(const char *dir_name);
 
 unsigned int cgi_mode = 0;
 FILE *out_file_desc;
+int cgi_client_fd = -1;
 
 static struct sigie_connection *sigie_conn = NULL;
 static int need_exit = 0;
+/* Threads of the pool, zero for a thread per available CPU */
+static unsigned int num_threads = 0;
+/* The file the results are kept in besides the memory */
+static const char *cache_file = NULL;
 
 void generic_signal_handler(int signum)
 {
@@ -67,6 +76,14 @@ int handle_scgi(void)
 	if (!sigie_conn)
 		return 1;
 
+#ifdef CONFIG_PARALLEL_COMP
+	/* The threads are shared by all the requests */
+	if (thread_pool_start(num_threads)) {
+		err = 7;
+		goto out;
+	}
+#endif
+
 	while (!need_exit) {
 		buffer = sigie_buffer_create();
 		if (!buffer) {
@@ -81,6 +98,7 @@ int handle_scgi(void)
 		}
 
 		fprintf(stderr, "Connection accepted.\n");
+		cgi_client_fd = io_sock_fd;
 
 		ret = sigie_receive(io_sock_fd, buffer);
 		if (-1 == ret) {
@@ -138,6 +156,7 @@ int handle_scgi(void)
 		sigie_buffer_destroy(buffer);
 
 		fprintf(stderr, "Connection closed.\n");
+		cgi_client_fd = -1;
 
 		io_sock_fd = -1;
 		buffer = NULL;
@@ -153,6 +172,10 @@ out:
 	if (sigie_conn && !need_exit)
 		sigie_connection_destroy(sigie_conn);
 
+#ifdef CONFIG_PARALLEL_COMP
+	thread_pool_stop();
+#endif
+
 	return err;
 }
 
@@ -212,6 +235,60 @@ int main(int argc, char **argv)
 	plugin_loaddir("plugins");
 	out_file_desc = stdout;
 
+	/* Options precede the mode */
+	while (argc > 2) {
+		if (0 == strcmp("--threads", argv[1])) {
+			if (atoi(argv[2]) <= 0) {
+				fprintf(stderr,
+					"Incorrect number of threads\n");
+				return 1;
+			}
+			num_threads = atoi(argv[2]);
+		} else if (0 == strcmp("--affinity", argv[1])) {
+			if (0 == strcmp("compact", argv[2])) {
+				thread_pool_set_affinity(AFFINITY_COMPACT);
+			} else if (0 == strcmp("scatter", argv[2])) {
+				thread_pool_set_affinity(AFFINITY_SCATTER);
+			} else {
+				fprintf(stderr, "Incorrect affinity\n");
+				return 1;
+			}
+		} else if (0 == strcmp("--workers", argv[1])) {
+			if (distributed_set_workers(argv[2])) {
+				fprintf(stderr, "Incorrect list of workers\n");
+				return 1;
+			}
+#ifdef CONFIG_CACHE_RESULT
+		} else if (0 == strcmp("--cache-size", argv[1])) {
+			if (atoi(argv[2]) <= 0) {
+				fprintf(stderr, "Incorrect size of the cache\n");
+				return 1;
+			}
+			/* In megabytes */
+			simple_cache_set_budget((uint64_t) atoi(argv[2]) << 20);
+		} else if (0 == strcmp("--cache-file", argv[1])) {
+			cache_file = argv[2];
+#endif
+		} else {
+			break;
+		}
+		argc -= 2;
+		argv += 2;
+	}
+
+#ifdef CONFIG_CACHE_RESULT
+	/* The CGI processes are started without the options */
+	if (!cache_file)
+		cache_file = getenv("WAVECAT_CACHE_FILE");
+	if (cache_file)
+		cache_file_open(cache_file);
+#endif
+
+#ifdef CONFIG_PARALLEL_COMP
+	if (num_threads && thread_pool_start(num_threads))
+		return 1;
+#endif
+
 	switch (argc) {
 	case 1:
 		return handle_cgi();
@@ -221,6 +298,11 @@ int main(int argc, char **argv)
 		} else {
 			return handle_basic(argv[1]);
 		}
+	case 3:
+		if (0 == strcmp("--worker", argv[1]))
+			return distributed_worker(argv[2]);
+		fprintf(stderr, "Incorrect arguments\n");
+		return 1;
 	default:
 		fprintf(stderr, "Incorrect number of arguments\n");
 		return 1;
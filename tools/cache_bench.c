@@ -0,0 +1,211 @@
+/**
+ * tools/cache_bench.c - microbenchmark of the cache of the results.
+ *
+ * NOTES:
+ *
+ * Built against the tree cache and against the hash one, see the cache_bench
+ * target of the Makefile:
+ *
+ *	$ ./cache_bench_tree.exe [entries] [threads]
+ *	$ ./cache_bench_hash.exe [entries] [threads]
+ *
+ * The entries are the points of a square grid of a catastrophe with four
+ * parameters. They are saved by one thread, then by all the threads in the
+ * batches of CONFIG_CACHE_BATCH under the lock of the root like the loops
+ * do, and looked up by 1, 2, 4 ... threads, a half of the keys missing.
+ * At last the budget is cut to a third of the memory taken, the entries
+ * saved by all the threads and never hit are to be evicted first.
+ */
+
+#include <kernel/core/config.h>
+#include <kernel/cache/simple.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#define BENCH_LOOKUPS 4000000UL
+/* Doubles taken by a key with four parameters */
+#define BENCH_KEY_SIZE (cached_result_size(4) / sizeof(double))
+
+unsigned int cgi_mode = 0;
+FILE *out_file_desc;
+
+struct bench_root {
+	void               *root;
+	pthread_spinlock_t  lock;
+};
+
+struct bench_thread {
+	pthread_t           thread;
+	struct bench_root  *root;
+	unsigned long       first;
+	unsigned long       num;
+	unsigned long       side;
+	double              shift;
+	unsigned long       found;
+};
+
+static void bench_key(struct cached_result *key, unsigned long i,
+		unsigned long side, double shift)
+{
+	key->num_parameters = 4;
+	key->parameter[0] = -10.0 + (i / side) * (20.0 / side);
+	key->parameter[1] = -10.0 + (i % side) * (20.0 / side);
+	key->parameter[2] = 0.5;
+	key->parameter[3] = shift;
+	key->point.module = i;
+	key->point.phase = 0;
+}
+
+static double bench_now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static void bench_save(struct bench_root *root,
+		double batch[][BENCH_KEY_SIZE], unsigned int num)
+{
+	unsigned int k;
+
+	pthread_spin_lock(&root->lock);
+	for (k = 0; k < num; k++)
+		simple_cache_save_result(&root->root,
+				(struct cached_result *) batch[k]);
+	pthread_spin_unlock(&root->lock);
+}
+
+static void *bench_insert(void *param)
+{
+	struct bench_thread *bt = param;
+	double batch[CONFIG_CACHE_BATCH][BENCH_KEY_SIZE];
+	unsigned long i;
+	unsigned int num = 0;
+
+	for (i = bt->first; i < bt->first + bt->num; i++) {
+		bench_key((struct cached_result *) batch[num++], i, bt->side,
+				bt->shift);
+
+		if (num == CONFIG_CACHE_BATCH) {
+			bench_save(bt->root, batch, num);
+			num = 0;
+		}
+	}
+	bench_save(bt->root, batch, num);
+
+	return NULL;
+}
+
+static void *bench_lookup(void *param)
+{
+	struct bench_thread *bt = param;
+	union cached_key key;
+	unsigned long i, seed = bt->first * 2654435761UL + 1;
+
+	for (i = 0; i < bt->num; i++) {
+		seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+		/* Every second key is of the missing row of the grid */
+		bench_key(&key.result, (seed >> 20) % (bt->side * bt->side), bt->side,
+				(seed >> 19) & 1 ? bt->shift : 1.0);
+		if (simple_cache_search_result(&bt->root->root, &key.result))
+			bt->found++;
+	}
+
+	return NULL;
+}
+
+static double bench_run(void *(*func)(void *), struct bench_root *root,
+		unsigned int num_threads, unsigned long num_items,
+		unsigned long side, double shift, unsigned long *found)
+{
+	struct bench_thread bt[64];
+	double start;
+	unsigned int t;
+
+	start = bench_now();
+	for (t = 0; t < num_threads; t++) {
+		bt[t].root  = root;
+		bt[t].first = num_items * t / num_threads;
+		bt[t].num   = num_items * (t + 1) / num_threads - bt[t].first;
+		bt[t].side  = side;
+		bt[t].shift = shift;
+		bt[t].found = 0;
+		pthread_create(&bt[t].thread, NULL, func, &bt[t]);
+	}
+
+	*found = 0;
+	for (t = 0; t < num_threads; t++) {
+		pthread_join(bt[t].thread, NULL);
+		*found += bt[t].found;
+	}
+
+	return bench_now() - start;
+}
+
+int main(int argc, char **argv)
+{
+	struct bench_root roots[2];
+	unsigned long num_entries = 1UL << 20, side, found;
+	unsigned int max_threads = 64, t;
+	double time;
+
+	if (argc > 1)
+		num_entries = strtoul(argv[1], NULL, 0);
+	if (argc > 2)
+		max_threads = atoi(argv[2]);
+	if (!max_threads || max_threads > 64) {
+		fprintf(stderr, "From 1 to 64 threads\n");
+		return 1;
+	}
+
+	for (side = 1; side * side < num_entries; side++)
+		;
+	num_entries = side * side;
+
+	memset(roots, 0, sizeof(roots));
+	pthread_spin_init(&roots[0].lock, PTHREAD_PROCESS_PRIVATE);
+	pthread_spin_init(&roots[1].lock, PTHREAD_PROCESS_PRIVATE);
+
+#ifdef CONFIG_CACHE_HASH
+	printf("hash cache, %lu entries\n", num_entries);
+#else
+	printf("tree cache, %lu entries\n", num_entries);
+#endif
+
+	time = bench_run(bench_insert, &roots[0], 1, num_entries, side, 0.0,
+			&found);
+	printf("insert  1 thread : %8.2f Mops/s\n", num_entries / time / 1e6);
+
+	time = bench_run(bench_insert, &roots[1], max_threads, num_entries,
+			side, 0.0, &found);
+	printf("insert %2u threads: %8.2f Mops/s\n", max_threads,
+			num_entries / time / 1e6);
+
+	for (t = 1;; t = (t * 2 < max_threads) ? t * 2 : max_threads) {
+		time = bench_run(bench_lookup, &roots[0], t, BENCH_LOOKUPS,
+				side, 0.0, &found);
+		printf("lookup %2u threads: %8.2f Mops/s, %lu%% found\n", t,
+				BENCH_LOOKUPS / time / 1e6,
+				found * 100 / BENCH_LOOKUPS);
+		if (t == max_threads)
+			break;
+	}
+
+	simple_cache_set_budget(num_entries * cached_result_size(4) * 2 / 3);
+	time = bench_now();
+	simple_cache_reclaim();
+	time = bench_now() - time;
+
+	bench_run(bench_lookup, &roots[0], 1, BENCH_LOOKUPS, side, 0.0, &found);
+	printf("evict to %3lu MB  : %8.2f ms, %lu%% found\n",
+			(unsigned long) (num_entries * cached_result_size(4) *
+				2 / 3) >> 20,
+			time * 1e3, found * 100 / BENCH_LOOKUPS);
+
+	return 0;
+}